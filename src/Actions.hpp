@@ -10,6 +10,7 @@
 #include <network/messages/HelloReply.hpp>
 #include <network/messages/StatisticsMessage.hpp>
 #include <network/messages/GamePause.hpp>
+#include <network/messages/RequestGamePause.hpp>
 #include <network/messages/GameStatus.hpp>
 #include <network/messages/MetaInformation.hpp>
 #include <network/messages/GameLeft.hpp>
@@ -18,6 +19,7 @@
 #include <util/Util.hpp>
 #include <util/UUID.hpp>
 #include <network/ErrorTypeEnum.hpp>
+#include <network/PayloadCache.hpp>
 #include <network/messages/Error.hpp>
 #include "Events.hpp"
 
@@ -44,18 +46,16 @@ namespace actions {
 
             // save requested role of the client
             root_machine(fsm).clientRoles[helloMessage.getClientId()] = helloMessage.getRole();
+            if (helloMessage.getRole() == spy::network::RoleEnum::SPECTATOR) {
+                root_machine(fsm).router.relaySpectator(helloMessage.getClientId());
+            }
 
             // Client ID is already assigned here, gets assigned directly after server receives hello callback from network
-            spy::network::messages::HelloReply helloReply{
-                    helloMessage.getClientId(),
-                    root_machine(fsm).sessionId,
-                    root_machine(fsm).scenarioConfig,
-                    root_machine(fsm).matchConfig,
-                    root_machine(fsm).characterInformations
-            };
-
-            spdlog::info("Sending HelloReply to {} ({})", helloMessage.getName(), helloReply.getClientId());
-            root_machine(fsm).router.sendMessage(helloReply);
+            // The configurations are spliced in from the payload cache instead of serializing them for every client
+            spdlog::info("Sending HelloReply to {} ({})", helloMessage.getName(), helloMessage.getClientId());
+            root_machine(fsm).router.sendRaw(helloMessage.getClientId(),
+                                             root_machine(fsm).payloadCache.helloReply(helloMessage.getClientId(),
+                                                                                       root_machine(fsm).sessionId));
         }
     };
 
@@ -111,6 +111,11 @@ namespace actions {
             fsm.router.sendMessage(fsm.playerIds.find(Player::one)->second, gameStarted);
             spdlog::info("Sending GameStarted message to player two");
             fsm.router.sendMessage(fsm.playerIds.find(Player::two)->second, gameStarted);
+
+            fsm.matchRecorder.start(fsm.sessionId, fsm.playerIds, fsm.playerNames, fsm.clock->now());
+            if (fsm.snapshotLog.has_value()) {
+                fsm.snapshotLog->clear();
+            }
         }
     };
 
@@ -184,6 +189,11 @@ namespace actions {
 
             spdlog::info("Winning player is {}", winner);
 
+            root_machine(fsm).matchRecorder.finish(state, root_machine(fsm).clock->now());
+            if (root_machine(fsm).snapshotLog.has_value()) {
+                root_machine(fsm).snapshotLog->clear();
+            }
+
             Statistics stats;
 
             stats.addEntry(StatisticsEntry{"Damage suffered", "Suffered damage of the factions",
@@ -200,12 +210,14 @@ namespace actions {
                                            std::to_string(gameStats.cocktailsPoured.first),
                                            std::to_string(gameStats.cocktailsPoured.second)});
 
+            root_machine(fsm).statistics.addEntries(stats);
+
             StatisticsMessage statisticsMessage{
                     {},
                     stats,
                     playerIds.at(winner),
                     victoryReason,
-                    false
+                    root_machine(fsm).matchRecorder.hasReplay()
             };
 
             spdlog::info("Sending Statistics: {}", fmt::json(stats, 4));
@@ -215,9 +227,10 @@ namespace actions {
             router.clearConnections();
 
             spdlog::debug("Resetting the game state for the next game");
-            root_machine(fsm).gameState = spy::gameplay::State{0, spy::scenario::FieldMap{
-                    root_machine(fsm).scenarioConfig}, {}, {}, std::nullopt,
-                                                               std::nullopt};
+            root_machine(fsm).gameState = spy::gameplay::State{0, root_machine(fsm).scenarioLayout->createMap(),
+                                                               {}, {}, std::nullopt, std::nullopt};
+            root_machine(fsm).gameOverTracker = {};
+            root_machine(fsm).statistics.reset();
         }
     };
 
@@ -253,7 +266,14 @@ namespace actions {
                 player = (playerIds.at(Player::one) == clientId) ? Player::one : Player::two;
             }
 
+            // Configurations are taken from the payload cache, only the other keys are evaluated per request
+            std::vector<MetaInformationKey> configurationKeys;
             for (const auto &key: metaInformationRequest.getKeys()) {
+                if (PayloadCache::isConfigurationKey(key)) {
+                    configurationKeys.push_back(key);
+                    continue;
+                }
+
                 auto result = Util::handleMetaRequestKey(key, fsm, gameRunning, isSpectator, player);
 
                 if (result.has_value()) {
@@ -261,16 +281,25 @@ namespace actions {
                 }
             }
 
-            MetaInformation metaInformationReply{metaInformationRequest.getClientId(), information};
-            root_machine(fsm).router.sendMessage(metaInformationReply);
+            root_machine(fsm).router.sendRaw(clientId, root_machine(fsm).payloadCache.metaInformation(
+                    clientId, configurationKeys, information));
         }
     };
 
     template<bool forced = false>
     struct pauseGame {
         template<typename Event, typename FSM, typename SourceState, typename TargetState>
-        void operator()(Event &&, FSM &fsm, SourceState &, TargetState &target) {
+        void operator()(Event &&event, FSM &fsm, SourceState &, TargetState &target) {
             target.serverEnforced = forced;
+            root_machine(fsm).statistics.gamePaused(root_machine(fsm).clock->now());
+            if constexpr (!forced) {
+                const spy::network::messages::RequestGamePause &pauseRequest = event;
+                for (const auto &[player, id] : root_machine(fsm).playerIds) {
+                    if (id == pauseRequest.getClientId()) {
+                        root_machine(fsm).statistics.pauseRequested(player);
+                    }
+                }
+            }
 
             spdlog::info("Pausing game, serverEnforced={}", forced);
             MessageRouter &router = root_machine(fsm).router;
@@ -284,6 +313,7 @@ namespace actions {
             bool isForced = std::is_same<Event, events::forceUnpause>::value;
 
             spdlog::info("Unpausing, forced={}", isForced);
+            root_machine(fsm).statistics.gameResumed(root_machine(fsm).clock->now());
             MessageRouter &router = root_machine(fsm).router;
             router.broadcastMessage(spy::network::messages::GamePause{{}, false, isForced});
         }
@@ -341,7 +371,7 @@ namespace actions {
                 // A normal pause is already in progress. We transition to forced pause and halt the pauseLimitTimer.
                 // The pause will be continued with the remaining time once everyone reconnected.
                 target.pauseLimitTimer.stop();
-                auto now = std::chrono::system_clock::now();
+                auto now = root_machine(fsm).clock->now();
                 // startTime has value because timer was just running.
                 auto pauseStart = target.pauseLimitTimer.getStartTime().value();
                 target.pauseTimeRemaining = now - pauseStart;
@@ -383,11 +413,11 @@ namespace actions {
             if (disconnectEvent.clientId == playerOneId) {
                 spdlog::info("Starting reconnect timer for player one for {} seconds",
                              std::chrono::duration_cast<std::chrono::seconds>(reconnectLimit).count());
-                target.playerOneReconnectTimer.restart(reconnectLimit, reconnectTimerEndP1);
+                target.playerOneReconnectTimer.restart(*root_machine(fsm).clock, reconnectLimit, reconnectTimerEndP1);
             } else {
                 spdlog::info("Starting reconnect timer for player two for {} seconds",
                              std::chrono::duration_cast<std::chrono::seconds>(reconnectLimit).count());
-                target.playerTwoReconnectTimer.restart(reconnectLimit, reconnectTimerEndP2);
+                target.playerTwoReconnectTimer.restart(*root_machine(fsm).clock, reconnectLimit, reconnectTimerEndP2);
             }
         }
     };
@@ -431,7 +461,7 @@ namespace actions {
                 spdlog::info("Restarting pause timer with {} seconds remaining.",
                              std::chrono::duration_cast<std::chrono::seconds>(remainingPauseTime).count());
 
-                target.pauseLimitTimer.restart(remainingPauseTime, [&fsm]() {
+                target.pauseLimitTimer.restart(*root_machine(fsm).clock, remainingPauseTime, [&fsm]() {
                     spdlog::info("Pause time limit reached, unpausing.");
                     root_machine(fsm).process_event(events::forceUnpause{});
                 });
@@ -30,6 +30,12 @@ namespace events {
     struct roundDone {
     };
 
+    /**
+     * Continues the session read from the snapshot file after a restart
+     */
+    struct restoreSession {
+    };
+
     struct playerDisconnect {
         spy::util::UUID clientId;
     };
@@ -12,9 +12,13 @@
 #include <fstream>
 #include <chrono>
 #include <ctime>
+#include <limits>
+#include <type_traits>
 #include <utility>
 #include <datatypes/character/CharacterInformation.hpp>
 #include <network/messages/HelloReply.hpp>
+#include <network/transport/WebSocketTransport.hpp>
+#include <network/transport/EpollTransport.hpp>
 
 const std::map<unsigned int, spdlog::level::level_enum> Server::verbosityMap = {
         {0, spdlog::level::level_enum::trace},
@@ -27,11 +31,94 @@ const std::map<unsigned int, spdlog::level::level_enum> Server::verbosityMap = {
         {7, spdlog::level::level_enum::trace}
 };
 
+namespace {
+    std::string option(const std::map<std::string, std::string> &options, const std::string &key,
+                       const std::string &defaultValue) {
+        auto value = options.find(key);
+        return value == options.end() ? defaultValue : value->second;
+    }
+
+    /**
+     * @return Value of a numeric option, defaultValue if the option is not given. Values that are no number of
+     *         the type (including negative values for unsigned types) end the server.
+     */
+    template<typename T>
+    T numericOption(const std::map<std::string, std::string> &options, const std::string &key, T defaultValue) {
+        auto value = options.find(key);
+        if (value == options.end()) {
+            return defaultValue;
+        }
+
+        const std::string &text = value->second;
+        try {
+            std::size_t parsed = 0;
+            if constexpr (std::is_floating_point_v<T>) {
+                auto number = std::stod(text, &parsed);
+                if (parsed == text.size()) {
+                    return static_cast<T>(number);
+                }
+            } else {
+                auto number = std::stoll(text, &parsed);
+                bool inRange = number >= static_cast<long long>(std::numeric_limits<T>::min()) and
+                               static_cast<unsigned long long>(number) <=
+                               static_cast<unsigned long long>(std::numeric_limits<T>::max());
+                if (parsed == text.size() and inRange) {
+                    return static_cast<T>(number);
+                }
+            }
+        } catch (const std::exception &) {
+            // reported below
+        }
+        spdlog::critical("Invalid value \"{}\" of option {}", text, key);
+        std::exit(1);
+    }
+
+    transport::EpollTransport::Options epollOptions(const std::map<std::string, std::string> &options) {
+        transport::EpollTransport::Options socketOptions;
+        socketOptions.tcpNoDelay = option(options, "tcpNoDelay", "1") != "0";
+        socketOptions.sendBufferSize = numericOption(options, "socketSendBuffer", 0);
+        socketOptions.receiveBufferSize = numericOption(options, "socketReceiveBuffer", 0);
+        socketOptions.statisticsInterval = std::chrono::seconds{numericOption(options, "transportStats", 0)};
+        return socketOptions;
+    }
+
+    /**
+     * Creates the transport selected by the option transport, the WebsocketCPP server by default. The epoll
+     * transport also serves the unix socket of the option ipcSocket on its event loop.
+     */
+    std::shared_ptr<transport::Transport> makeTransport(uint16_t port,
+                                                       const std::map<std::string, std::string> &options) {
+        using transport::EpollTransport;
+
+        auto backend = option(options, "transport", "websocket");
+        if (backend == "epoll") {
+            std::vector<EpollTransport::Endpoint> endpoints = {EpollTransport::Endpoint::webSocket(port)};
+            auto ipcSocket = options.find("ipcSocket");
+            if (ipcSocket != options.end()) {
+                endpoints.push_back(EpollTransport::Endpoint::unixSocket(ipcSocket->second));
+            }
+            return std::make_shared<EpollTransport>(std::move(endpoints), "no-time-to-spy", epollOptions(options));
+        }
+        if (backend != "websocket") {
+            spdlog::critical("Unknown transport {}, use websocket or epoll", backend);
+            std::exit(1);
+        }
+        return std::make_shared<transport::WebSocketTransport>(port, "no-time-to-spy");
+    }
+}
+
 Server::Server(uint16_t port, unsigned int verbosity, const std::string &characterPath, const std::string &matchPath,
                const std::string &scenarioPath, std::map<std::string, std::string> additionalOptions) :
+        Server(makeTransport(port, additionalOptions), verbosity, characterPath, matchPath, scenarioPath,
+               additionalOptions) {}
+
+Server::Server(std::shared_ptr<transport::Transport> transport, unsigned int verbosity,
+               const std::string &characterPath, const std::string &matchPath, const std::string &scenarioPath,
+               std::map<std::string, std::string> additionalOptions, std::shared_ptr<Clock> clock) :
         verbosity(verbosity),
         additionalOptions(std::move(additionalOptions)),
-        router(port, "no-time-to-spy") {
+        router(std::move(transport)),
+        clock(std::move(clock)) {
     configureLogging();
 
     spdlog::info("Server called with following arguments: ");
@@ -39,7 +126,17 @@ Server::Server(uint16_t port, unsigned int verbosity, const std::string &charact
     spdlog::info(" -> match configuration:     {}", matchPath);
     spdlog::info(" -> scenario configuration:  {}", scenarioPath);
     spdlog::info(" -> verbosity:               {}", verbosity);
-    spdlog::info(" -> port:                    {}", port);
+    auto ipcSocket = this->additionalOptions.find("ipcSocket");
+    if (ipcSocket != this->additionalOptions.end() and option(this->additionalOptions, "transport", "") != "epoll") {
+        // The websocket and in-memory transports have no event loop to share, the unix socket gets its own
+        using transport::EpollTransport;
+        router.addTransport(std::make_shared<EpollTransport>(
+                std::vector<EpollTransport::Endpoint>{EpollTransport::Endpoint::unixSocket(ipcSocket->second)},
+                "", epollOptions(this->additionalOptions)));
+    }
+    for (const auto &transport : router.getTransports()) {
+        spdlog::info(" -> transport:               {}", transport->description());
+    }
     if (!this->additionalOptions.empty()) {
         spdlog::info(" -> additional:");
         for (const auto &elem : this->additionalOptions) {
@@ -55,20 +152,16 @@ Server::Server(uint16_t port, unsigned int verbosity, const std::string &charact
         std::exit(1);
     }
 
+    payloadCache = PayloadCache{scenarioConfig, matchConfig, characterInformations};
+
     spdlog::info("Cat UUID is {}", catId);
     spdlog::info("Janitor UUID is {}", janitorId);
 
-    gameState = spy::gameplay::State{0, spy::scenario::FieldMap{scenarioConfig}, {}, {}, std::nullopt,
-                                     std::nullopt};
+    scenarioLayout = ScenarioLayout::shared(scenarioConfig);
+    gameState = spy::gameplay::State{0, scenarioLayout->createMap(), {}, {}, std::nullopt, std::nullopt};
 
     // check if the scenario contains enough fields needed to place all characters + cat + janitor
-    unsigned int accessibleFields = 0;
-    gameState.getMap().forAllFields([&accessibleFields](const spy::scenario::Field &f) {
-        if (f.getFieldState() == spy::scenario::FieldStateEnum::FREE
-            || f.getFieldState() == spy::scenario::FieldStateEnum::BAR_SEAT) {
-            accessibleFields++;
-        }
-    });
+    auto accessibleFields = scenarioLayout->getAccessibleFields().size();
 
     // Explanation of the number 10: 2x max. 4 characters + cat + janitor
     if (accessibleFields < maxNumberOfNPCs + 10) {
@@ -77,10 +170,54 @@ Server::Server(uint16_t port, unsigned int verbosity, const std::string &charact
         std::exit(1);
     }
 
+    // The seed of the placements and the round order, a capture records it so a replay draws the same numbers
+    auto seed = numericOption(this->additionalOptions, "seed", rd());
+    rng.seed(seed);
+
+    statePool = std::make_unique<GameStatePool>(
+            scenarioLayout, matchConfig.getMinChipsRoulette(), matchConfig.getMaxChipsRoulette(),
+            numericOption(this->additionalOptions, "statePool", GameStatePool::defaultCapacity),
+            rng());
+    occupancy = std::make_unique<OccupancyGrid>(scenarioLayout);
+
+    auto captureFile = this->additionalOptions.find("capture");
+    if (captureFile != this->additionalOptions.end()) {
+        router.startCapture(captureFile->second, seed);
+    }
+
+    if (this->additionalOptions.find("spectatorRelay") != this->additionalOptions.end()) {
+        router.startSpectatorRelay(numericOption(this->additionalOptions, "spectatorRelay", 0u));
+    }
+
+    auto spectatorPolicy = this->additionalOptions.find("spectatorPolicy");
+    if (spectatorPolicy != this->additionalOptions.end()) {
+        auto maxQueueDepth = numericOption(this->additionalOptions, "spectatorMaxQueue",
+                                           SpectatorThrottle::defaultMaxQueueDepth);
+        auto maxCpuLoad = numericOption(this->additionalOptions, "spectatorMaxCpu", 0.0);
+        try {
+            spectatorThrottle = SpectatorThrottle::fromOption(spectatorPolicy->second, maxQueueDepth, maxCpuLoad);
+        } catch (const std::exception &e) {
+            spdlog::critical("Invalid spectator policy: {}", e.what());
+            std::exit(1);
+        }
+    }
+
+    auto snapshotFile = this->additionalOptions.find("snapshotFile");
+    if (snapshotFile != this->additionalOptions.end()) {
+        restoredSession = SnapshotLog::readSession(snapshotFile->second);
+        if (restoredSession.has_value()) {
+            spdlog::info("Found session {} in snapshot file {}", restoredSession->at("sessionId").dump(),
+                         snapshotFile->second);
+        }
+        snapshotLog.emplace(snapshotFile->second);
+    }
+
     using serverFSM = afsm::state_machine<Server>;
     auto &fsm = static_cast<serverFSM &>(*this);
 
-    router.addHelloListener([&fsm, this](spy::network::messages::Hello msg, MessageRouter::connectionPtr con) {
+    using namespace spy::network::messages;
+
+    router.addListener<Hello>([&fsm, this](Hello &&msg, const MessageRouter::connectionPtr &con) {
         // New clients send Hello, and need to be assigned a UUID immediately.
         // This new UUID gets inserted into the HelloMessage, so the FSM receives properly formatted HelloMessage
         spdlog::info("Server received Hello message, initializing UUID");
@@ -88,45 +225,50 @@ Server::Server(uint16_t port, unsigned int verbosity, const std::string &charact
         spdlog::info("Registering UUID {} at router", msg.getClientId());
         router.registerUUIDforConnection(msg.getClientId(), con);
         spdlog::info("Posting event to FSM now");
-        fsm.process_event(msg);
+        fsm.process_event(std::move(msg));
     });
 
-    auto forwardMessage = [&fsm, this](auto msg) {
-        auto clientRole = clientRoles.find(msg.getClientId());
+    // The router filters messages by the role of the sender before decoding them
+    router.setRoleProvider([this](const spy::util::UUID &clientId) -> std::optional<spy::network::RoleEnum> {
+        auto clientRole = clientRoles.find(clientId);
         if (clientRole == clientRoles.end()) {
-            return;
+            return std::nullopt;
         }
+        return clientRole->second;
+    });
 
-        if (Util::isAllowedMessage(clientRole->second, msg)) {
-            fsm.process_event(msg);
-        } else {
-            // message dropped --> send illegal message error
-            spdlog::warn("Client {} sent an {} message that was dropped due to role filtering",
-                         msg.getClientId(), fmt::json(msg.getType()));
-            spdlog::warn("Sending ILLEGAL_MESSAGE error and kicking client");
-
-            spy::network::messages::Error errorMessage{msg.getClientId(),
-                                                       spy::network::ErrorTypeEnum::ILLEGAL_MESSAGE};
-            router.sendMessage(errorMessage);
-            fsm.process_event(events::kickClient{msg.getClientId()});
-        }
-    };
+    router.addIllegalMessageListener([&fsm, this](const spy::util::UUID &clientId, MessageTypeEnum) {
+        // message dropped --> send illegal message error
+        spdlog::warn("Sending ILLEGAL_MESSAGE error and kicking client");
+        Error errorMessage{clientId, spy::network::ErrorTypeEnum::ILLEGAL_MESSAGE};
+        router.sendMessage(errorMessage);
+        fsm.process_event(events::kickClient{clientId});
+    });
 
-    auto discardNotImplemented = [](auto msg) {
-        spdlog::warn("Received message of type {}, handling is not implemented.", fmt::json(msg.getType()));
+    // Messages are moved from the router into the FSM without being copied
+    auto forwardMessage = [&fsm](auto &&msg, const MessageRouter::connectionPtr &) {
+        fsm.process_event(std::forward<decltype(msg)>(msg));
     };
 
-    router.addItemChoiceListener(forwardMessage);
-    router.addEquipmentChoiceListener(forwardMessage);
-    router.addGameOperationListener(forwardMessage);
-    router.addPauseRequestListener(forwardMessage);
-    router.addMetaInformationRequestListener(forwardMessage);
-    router.addReplayRequestListener(discardNotImplemented);
-    router.addGameLeaveListener(forwardMessage);
-
-    router.addReconnectListener(
-            [this, forwardMessage](const spy::network::messages::Reconnect &msg,
-                                   const MessageRouter::connectionPtr &con) {
+    router.addListener<ItemChoice>(forwardMessage);
+    router.addListener<EquipmentChoice>(forwardMessage);
+    router.addListener<GameOperation>(forwardMessage);
+    router.addListener<RequestGamePause>(forwardMessage);
+    router.addListener<RequestMetaInformation>(forwardMessage);
+    router.addListener<RequestReplay>([this](RequestReplay &&msg, const MessageRouter::connectionPtr &) {
+        if (not matchRecorder.hasReplay()) {
+            spdlog::warn("Client {} requested a replay, but no game has been finished yet.", msg.getClientId());
+            return;
+        }
+
+        spdlog::info("Sending replay to client {}", msg.getClientId());
+        router.sendRaw(msg.getClientId(), matchRecorder.createReplay(msg.getClientId(), scenarioConfig,
+                                                                     matchConfig, characterInformations));
+    });
+    router.addListener<GameLeave>(forwardMessage);
+
+    router.addListener<Reconnect>(
+            [&fsm, this](Reconnect &&msg, const MessageRouter::connectionPtr &con) {
                 if (msg.getSessionId() != sessionId) {
                     spdlog::warn(
                             "Reconnect message from client {} specifies sessionId {}, but current sessionId is {}.",
@@ -153,7 +295,8 @@ Server::Server(uint16_t port, unsigned int verbosity, const std::string &charact
                 spdlog::info("Server received Reconnect message, with client ID {}", msg.getClientId());
                 spdlog::info("Registering client UUID {} at router after reconnect", msg.getClientId());
                 router.registerUUIDforConnection(msg.getClientId(), con);
-                forwardMessage(msg);
+                statistics.reconnected(playerIds.at(Player::one) == clientId ? Player::one : Player::two);
+                fsm.process_event(std::move(msg));
             });
 
     router.addDisconnectListener([&fsm, this](const spy::util::UUID &uuid) {
@@ -173,6 +316,16 @@ Server::Server(uint16_t port, unsigned int verbosity, const std::string &charact
     });
 }
 
+bool Server::resumeSession() {
+    if (not restoredSession.has_value()) {
+        return false;
+    }
+
+    spdlog::info("Resuming session from snapshot file");
+    static_cast<afsm::state_machine<Server> &>(*this).process_event(events::restoreSession{});
+    return true;
+}
+
 void Server::configureLogging() const {
     std::vector<spdlog::sink_ptr> sinks;
     std::string logFile(30, '\0');
@@ -193,19 +346,26 @@ void Server::configureLogging() const {
     consoleSink->set_color_mode(spdlog::color_mode::always);
     consoleSink->set_level(it->second);
 
-    // logging to file always works with max logging level
-    auto fileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/" + logFile);
-    fileSink->set_level(spdlog::level::level_enum::trace);
-
     sinks.push_back(consoleSink);
-    sinks.push_back(fileSink);
+
+    // "--x logFile none" disables the file sink, e.g. for benchmarks where logging would dominate
+    auto logFileOption = additionalOptions.find("logFile");
+    bool logToFile = logFileOption == additionalOptions.end() or logFileOption->second != "none";
+
+    if (logToFile) {
+        // logging to file always works with max logging level
+        auto fileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/" + logFile);
+        fileSink->set_level(spdlog::level::level_enum::trace);
+        sinks.push_back(fileSink);
+    }
 
     auto combined_logger = std::make_shared<spdlog::logger>("Logger", begin(sinks), end(sinks));
 
     // Flush for every message of level info or higher
     combined_logger->flush_on(spdlog::level::info);
 
-    combined_logger->set_level(spdlog::level::trace);
+    // without the file sink, messages below the console level don't need to be formatted at all
+    combined_logger->set_level(logToFile ? spdlog::level::trace : it->second);
 
     // use this new combined sink as default logger
     spdlog::set_default_logger(combined_logger);
@@ -13,11 +13,24 @@
 #include "datatypes/scenario/Scenario.hpp"
 #include "datatypes/character/CharacterDescription.hpp"
 #include "network/MessageRouter.hpp"
+#include "network/PayloadCache.hpp"
+#include "network/AddressableFrame.hpp"
+#include "network/SpectatorThrottle.hpp"
 #include "network/messages/Hello.hpp"
 #include "network/messages/GameLeave.hpp"
 #include <Events.hpp>
 #include <game/GameFSM.hpp>
 #include <random>
+#include <util/Clock.hpp>
+#include <util/MatchRecorder.hpp>
+#include <util/SnapshotLog.hpp>
+#include <util/ScenarioLayout.hpp>
+#include <util/GameStatePool.hpp>
+#include <util/OccupancyGrid.hpp>
+#include <util/CharacterIndex.hpp>
+#include <util/GameOverTracker.hpp>
+#include <util/StatisticsAggregator.hpp>
+#include <optional>
 #include<Actions.hpp>
 
 constexpr unsigned int defaultMaxNPCs = 8;
@@ -32,6 +45,25 @@ class Server : public afsm::def::state_machine<Server> {
                const std::string &scenarioPath,
                std::map<std::string, std::string> additionalOptions);
 
+        /**
+         * Creates a server accepting clients from the given transport instead of a websocket server.
+         * @param clock Time source of all timers, a VirtualClock allows to fast-forward timeouts
+         */
+        Server(std::shared_ptr<transport::Transport> transport,
+               unsigned int verbosity,
+               const std::string &characterPath,
+               const std::string &matchPath,
+               const std::string &scenarioPath,
+               std::map<std::string, std::string> additionalOptions,
+               std::shared_ptr<Clock> clock = std::make_shared<SystemClock>());
+
+        /**
+         * Continues the session read from the snapshot file (--x snapshotFile), if there is one. The game is
+         * paused until both players reconnected with the session id of the restored session.
+         * @return True if a session was restored
+         */
+        bool resumeSession();
+
         struct emptyLobby : state<emptyLobby> {
             template<typename FSM, typename Event>
             void on_enter(Event &&, FSM &fsm) {
@@ -61,6 +93,7 @@ class Server : public afsm::def::state_machine<Server> {
         using transitions = transition_table <
         // Start           Event                              Next            Action                                                                                                Guard
         tr<emptyLobby,     spy::network::messages::Hello,     waitFor2Player, actions::multiple<actions::InitializeSession, actions::HelloReply>,                                   and_<guards::isPlayer, guards::isNameUnused>>,
+        tr<emptyLobby,     events::restoreSession,            decltype(game), actions::restoreSession>,
         tr<waitFor2Player, spy::network::messages::GameLeave, emptyLobby,     actions::multiple<actions::broadcastGameLeft, actions::closeConnectionToClient>,                      guards::isPlayer>,
         tr<waitFor2Player, events::playerDisconnect,          emptyLobby>,
         tr<waitFor2Player, spy::network::messages::Hello,     decltype(game), actions::multiple<actions::HelloReply, actions::StartGame>,                                           and_<guards::isPlayer, guards::isNameUnused>>,
@@ -86,18 +119,48 @@ class Server : public afsm::def::state_machine<Server> {
         spy::MatchConfig matchConfig;
         spy::scenario::Scenario scenarioConfig;
 
+        /**
+         * Static layout of the scenario, the map of every game is copied from it.
+         */
+        std::shared_ptr<const ScenarioLayout> scenarioLayout;
+
         /**
          * Characters from configuration file + UUIDs
          */
         std::vector<spy::character::CharacterInformation> characterInformations;
 
+        /**
+         * Serialized configurations for HelloReply and MetaInformation messages, created after loading them.
+         */
+        PayloadCache payloadCache;
+
         MessageRouter router;
 
+        /**
+         * Time source of all timers of the FSM.
+         */
+        std::shared_ptr<Clock> clock;
+
         /**
          * Current game state, contains characters and faction information after successful equipment phase.
          */
         spy::gameplay::State gameState;
 
+        /**
+         * Characters of the game state by UUID, rebuilt whenever characters are added or removed.
+         */
+        CharacterIndex characterIndex;
+
+        /**
+         * Game over condition of the current game, evaluated when an operation can have changed it.
+         */
+        GameOverTracker gameOverTracker;
+
+        /**
+         * Statistics of the current game, collected from the operations, turns, strikes, pauses and reconnects.
+         */
+        StatisticsAggregator statistics;
+
         /**
          * This should be true when the current state is GameFSM::gamePhase
          * (direct checking not possible in guards::gameOver)
@@ -133,6 +196,16 @@ class Server : public afsm::def::state_machine<Server> {
         std::random_device rd{};
         std::mt19937 rng{rd()};
 
+        /**
+         * Maps and character placements of the next games, prepared in the background.
+         */
+        std::unique_ptr<GameStatePool> statePool;
+
+        /**
+         * Occupants of the fields of the current game, updated after every executed operation.
+         */
+        std::unique_ptr<OccupancyGrid> occupancy;
+
         /**
          * UUID of the cat
          */
@@ -151,6 +224,31 @@ class Server : public afsm::def::state_machine<Server> {
 
         unsigned int maxNumberOfNPCs = defaultMaxNPCs;
 
+        /**
+         * Records the game phase of the current or last match for replay requests.
+         */
+        MatchRecorder matchRecorder;
+
+        /**
+         * Spectator GameStatus of the last broadcast, sent to spectators joining during the game phase.
+         */
+        AddressableFrame lastSpectatorStatus;
+
+        /**
+         * Decides which broadcasts reach the spectators, configured by the option spectatorPolicy.
+         */
+        SpectatorThrottle spectatorThrottle;
+
+        /**
+         * Crash-consistent log of the game phase, only present if the option snapshotFile is given.
+         */
+        std::optional<SnapshotLog> snapshotLog;
+
+        /**
+         * Session read from the snapshot file at startup, reset once it has been restored.
+         */
+        std::optional<nlohmann::json> restoredSession;
+
     private:
         const static std::map<unsigned int, spdlog::level::level_enum> verbosityMap;
 
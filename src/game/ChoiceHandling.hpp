@@ -8,6 +8,7 @@
 #ifndef SERVER017_CHOICE_HANDLING_HPP
 #define SERVER017_CHOICE_HANDLING_HPP
 
+#include <map>
 #include <datatypes/gadgets/WiretapWithEarplugs.hpp>
 
 namespace actions {
@@ -141,8 +142,6 @@ namespace actions {
 
             spy::character::CharacterSet charSet;
 
-            spy::character::FactionEnum faction;
-
             auto remainingCharacters = choiceSet.getRemainingCharacters();
             auto remainingGadgets = choiceSet.getRemainingGadgets();
 
@@ -158,26 +157,29 @@ namespace actions {
                 }
             }
 
-            // for each character, insert it into the character set if it has been chosen by a client or
-            // assigned to the NPC faction
+            // faction of every character chosen by a client or assigned to the NPC faction
+            std::map<spy::util::UUID, spy::character::FactionEnum> factions;
+            for (const auto &id : npcCharacters) {
+                factions[id] = spy::character::FactionEnum::NEUTRAL;
+            }
+            for (const auto &id : charsP2) {
+                factions[id] = spy::character::FactionEnum::PLAYER2;
+            }
+            for (const auto &id : charsP1) {
+                factions[id] = spy::character::FactionEnum::PLAYER1;
+            }
+
+            // for each character, insert it into the character set if it has a faction
             for (const auto &c : charInfos) {
-                // search for the character UUID in the list of characters of the players and the NPCs and
-                // set it's faction to the corresponding value
-                if (std::find(charsP1.begin(), charsP1.end(), c.getCharacterId()) != charsP1.end()) {
-                    faction = spy::character::FactionEnum::PLAYER1;
-                } else if (std::find(charsP2.begin(), charsP2.end(), c.getCharacterId()) != charsP2.end()) {
-                    faction = spy::character::FactionEnum::PLAYER2;
-                } else if (std::find(npcCharacters.begin(), npcCharacters.end(), c.getCharacterId()) !=
-                           npcCharacters.end()) {
-                    faction = spy::character::FactionEnum::NEUTRAL;
-                } else {
+                auto faction = factions.find(c.getCharacterId());
+                if (faction == factions.end()) {
                     continue;
                 }
 
                 auto character = spy::character::Character{c.getCharacterId(), c.getName()};
                 character.setProperties(
                         std::set<spy::character::PropertyEnum>{c.getFeatures().begin(), c.getFeatures().end()});
-                character.setFaction(faction);
+                character.setFaction(faction->second);
                 charSet.insert(character);
             }
 
@@ -204,6 +206,7 @@ namespace actions {
             }
 
             gameState.setCharacters(charSet);
+            root_machine(fsm).characterIndex.rebuild(gameState.getCharacters());
 
             // give information about choices to the equip phase
             t.chosenCharacters = s.characterChoices;
@@ -229,6 +232,7 @@ namespace actions {
                     spdlog::info("Starting choice phase reconnect timer for player one for {} seconds",
                                  reconnectLimit.value());
                     target.playerOneReconnectTimer.restart(
+                            *root_machine(fsm).clock,
                             std::chrono::seconds{reconnectLimit.value()},
                             [&fsm]() {
                                 TargetState::limitReached(fsm, Player::one);
@@ -237,6 +241,7 @@ namespace actions {
                     spdlog::info("Starting choice phase reconnect timer for player two for {} seconds",
                                  reconnectLimit.value());
                     target.playerTwoReconnectTimer.restart(
+                            *root_machine(fsm).clock,
                             std::chrono::seconds{reconnectLimit.value()},
                             [&fsm]() {
                                 TargetState::limitReached(fsm, Player::two);
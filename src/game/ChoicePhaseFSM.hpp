@@ -14,6 +14,7 @@
 #include <Actions.hpp>
 
 #include "game/ChoiceHandling.hpp"
+#include "game/SnapshotHandling.hpp"
 
 static const std::vector<spy::gadget::GadgetEnum> possibleGadgets = {
         spy::gadget::GadgetEnum::HAIRDRYER,
@@ -63,6 +64,12 @@ struct ChoicePhase : afsm::def::state_def<ChoicePhase> {
 
     template<typename FSM, typename Event>
     void on_enter(Event &&, FSM &fsm) {
+        if constexpr (snapshot::isRestore<Event>()) {
+            // A restored session continues in the game phase, the choices have been made before the restart
+            root_machine(fsm).process_event(events::restoreSession{});
+            return;
+        }
+
         spdlog::info("Entering choice phase");
 
         // get access to the members of the root fsm
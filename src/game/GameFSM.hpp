@@ -16,10 +16,12 @@
 #include "Guards.hpp"
 #include "Actions.hpp"
 #include "util/Player.hpp"
+#include "util/Util.hpp"
 #include "spdlog/fmt/ostr.h"
 #include "OperationHandling.hpp"
 #include "util/ChoiceSet.hpp"
 #include "ChoicePhaseFSM.hpp"
+#include "SnapshotHandling.hpp"
 #include "EquipChoiceHandling.hpp"
 #include "util/Timer.hpp"
 
@@ -92,60 +94,52 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
                 spdlog::info("Initial entering to game phase");
 
                 root_machine(fsm).isIngame = true;
+                root_machine(fsm).lastSpectatorStatus = {};
+                root_machine(fsm).spectatorThrottle.reset();
+                root_machine(fsm).occupancy->clear();
+
+                if constexpr (snapshot::isRestore<Event>()) {
+                    // Map and characters are part of the restored state, only the round order is missing
+                    const nlohmann::json &session = root_machine(fsm).restoredSession.value();
+                    activeCharacter = session.at("activeCharacter").get<spy::util::UUID>();
+                    remainingCharacters = session.at("remainingCharacters").get<std::deque<spy::util::UUID>>();
+                    root_machine(fsm).occupancy->update(root_machine(fsm).gameState);
+                    root_machine(fsm).gameOverTracker.evaluate(root_machine(fsm).gameState);
+                    return;
+                }
 
                 spy::gameplay::State &gameState = root_machine(fsm).gameState;
-                spy::MatchConfig &config = root_machine(fsm).matchConfig;
-                std::mt19937 &rng = root_machine(fsm).rng;
                 auto &knownCombinations = root_machine(fsm).knownCombinations;
 
                 knownCombinations[Player::one] = {};
                 knownCombinations[Player::two] = {};
 
-                std::vector<unsigned int> safeIndexes;
-
-                gameState.getMap().forAllFields([&safeIndexes](const spy::scenario::Field &f) {
-                    if (f.getFieldState() == spy::scenario::FieldStateEnum::SAFE) {
-                        safeIndexes.push_back(safeIndexes.size() + 1);
-                    }
-                });
-
-                std::shuffle(safeIndexes.begin(), safeIndexes.end(), root_machine(fsm).rng);
-
-                auto indexIterator = safeIndexes.begin();
-
-                // Initialize roulette tables with random amount of chips, safes with an index
-                gameState.getMap().forAllFields([&rng, &config, &indexIterator](spy::scenario::Field &field) {
-                    if (field.getFieldState() == spy::scenario::FieldStateEnum::ROULETTE_TABLE) {
-                        std::uniform_int_distribution<unsigned int> randChips(config.getMinChipsRoulette(),
-                                                                              config.getMaxChipsRoulette());
-
-                        field.setChipAmount(randChips(rng));
-                    } else if (field.getFieldState() == spy::scenario::FieldStateEnum::SAFE) {
-                        field.setSafeIndex(*indexIterator);
-                        indexIterator++;
-                    }
-                });
+                // Chips, safe indices and the fields for the characters were prepared in the background
+                auto prepared = root_machine(fsm).statePool->take();
+                gameState.getMap() = std::move(prepared.map);
+                auto placement = prepared.placements.begin();
 
                 // Randomly distribute characters
                 spdlog::info("Distributing characters");
                 for (auto &character: gameState.getCharacters()) {
-                    auto randomField = spy::util::GameLogicUtils::getRandomCharacterFreeMapPoint(gameState);
-                    if (!randomField.has_value()) {
+                    if (placement == prepared.placements.end()) {
                         spdlog::critical("No field to place character");
                         std::exit(1);
                     }
-                    spdlog::debug("Placing {} at {}", character.getName(), fmt::json(randomField.value()));
-                    character.setCoordinates(randomField.value());
+                    spdlog::debug("Placing {} at {}", character.getName(), fmt::json(*placement));
+                    character.setCoordinates(*placement);
+                    placement++;
                 }
 
                 // place the cat on a random field
-                auto randomField = spy::util::GameLogicUtils::getRandomCharacterFreeMapPoint(gameState);
-                if (!randomField.has_value()) {
+                if (placement == prepared.placements.end()) {
                     spdlog::critical("No field to place the white cat");
                     std::exit(1);
                 }
-                spdlog::debug("Placing white cat at {}", fmt::json(randomField.value()));
-                gameState.setCatCoordinates(randomField.value());
+                spdlog::debug("Placing white cat at {}", fmt::json(*placement));
+                gameState.setCatCoordinates(*placement);
+                root_machine(fsm).occupancy->update(gameState);
+                root_machine(fsm).gameOverTracker.evaluate(gameState);
             }
 
             template<typename FSM, typename Event>
@@ -162,16 +156,24 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
             struct roundInit : state<roundInit> {
                 template<typename FSM, typename Event>
                 void on_enter(Event &&, FSM &fsm) {
-                    using spy::util::GameLogicUtils;
                     using spy::scenario::FieldStateEnum;
-                    using spy::util::RoundUtils;
                     using spy::gadget::Gadget;
                     using spy::gadget::GadgetEnum;
                     using spy::character::FactionEnum;
 
+                    if constexpr (snapshot::isRestore<Event>()) {
+                        // The restored round continues, the game is paused until the players reconnected
+                        root_machine(fsm).process_event(events::restoreSession{});
+                        return;
+                    }
+
                     auto &characters = root_machine(fsm).gameState.getCharacters();
                     spy::gameplay::State &state = root_machine(fsm).gameState;
                     const spy::MatchConfig &matchConfig = root_machine(fsm).matchConfig;
+
+                    if (state.getCurrentRound() > 0) {
+                        root_machine(fsm).matchRecorder.finishRound(fsm.activeCharacter, state);
+                    }
                     state.incrementRoundCounter();
 
                     spdlog::info("Entering state roundInit for round {}", state.getCurrentRound());
@@ -180,7 +182,7 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
                     if (state.getCurrentRound() >= matchConfig.getRoundLimit()) {
                         // if the janitor wasn't previously on the map, this is the first round with special mechanics
                         if (!state.getJanitorCoordinates().has_value()) {
-                            auto randomField = GameLogicUtils::getRandomCharacterFreeMapPoint(state);
+                            auto randomField = root_machine(fsm).occupancy->randomFreeField(root_machine(fsm).rng);
 
                             if (!randomField.has_value()) {
                                 spdlog::critical("No field to place the janitor");
@@ -191,17 +193,17 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
 
                             // all NPCs leave the casino
                             state.removeAllNPCs();
+                            root_machine(fsm).occupancy->update(state);
+                            root_machine(fsm).characterIndex.rebuild(state.getCharacters());
                         }
 
                         fsm.remainingCharacters.push_back(root_machine(fsm).janitorId);
                     }
 
-                    for (const auto &c: characters) {
-                        if (c.getCoordinates().has_value()) {
-                            fsm.remainingCharacters.push_back(c.getCharacterId());
-                        }
-                    }
+                    // The janitor is followed by the characters and the cat before shuffling
+                    Util::initRound(state, matchConfig, fsm.remainingCharacters);
                     fsm.remainingCharacters.push_back(root_machine(fsm).catId);
+                    root_machine(fsm).gameOverTracker.evaluate(state);
 
                     std::shuffle(fsm.remainingCharacters.begin(), fsm.remainingCharacters.end(), root_machine(fsm).rng);
 
@@ -214,24 +216,19 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
                         } else if (uuid == root_machine(fsm).janitorId) {
                             spdlog::info("Janitor");
                         } else {
-                            spdlog::info("{} \t({})", characters.findByUUID(uuid)->getName(), uuid);
+                            spdlog::info("{} \t({})",
+                                         root_machine(fsm).characterIndex.find(characters, uuid)->getName(), uuid);
                         }
                     }
 
-                    RoundUtils::refillBarTables(state);
-                    RoundUtils::updateFog(state);
-                    RoundUtils::checkGadgetFailure(state, matchConfig);
-                    RoundUtils::resetUpdatedMarker(state);
-                    for (auto &character: state.getCharacters()) {
-                        RoundUtils::determinePoints(character);
-                    }
+                    snapshot::writeCheckpoint(fsm);
 
                     root_machine(fsm).process_event(events::roundInitDone{});
                 }
 
                 using internal_transitions = transition_table <
                 // Event                          Action                                                               Guard
-                in<spy::network::messages::Hello, actions::multiple<actions::HelloReply, actions::broadcastState>, guards::isSpectator>>;
+                in<spy::network::messages::Hello, actions::multiple<actions::HelloReply, actions::sendCachedState>, guards::isSpectator>>;
                 // @formatter:on
             };
 
@@ -250,13 +247,13 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
                 // @formatter:off
                 using internal_transitions = transition_table <
                 // Event                                  Action                                                                                                                                                                               Guard
-                in<spy::network::messages::GameOperation, actions::multiple<actions::handleOperation, actions::broadcastState, actions::requestNextOperation>,                                                                                 guards::operationValid>,
-                in<events::skipOperation,                 actions::multiple<actions::broadcastState, actions::requestNextOperation>>,
+                in<spy::network::messages::GameOperation, actions::multiple<actions::handleOperation, actions::writeOperationEntry, actions::broadcastState, actions::requestNextOperation>,                                                                                 guards::operationValid>,
+                in<events::skipOperation,                 actions::multiple<actions::writeOperationEntry, actions::broadcastState, actions::requestNextOperation>>,
                 in<spy::network::messages::GameOperation, actions::multiple<actions::replyWithError<spy::network::ErrorTypeEnum::ILLEGAL_MESSAGE>, actions::closeConnectionToClient, actions::broadcastGameLeft, actions::emitForceGameClose>, not_<guards::operationValid>>,
                 in<events::triggerNPCmove,                actions::multiple<actions::generateNPCMove>>,
-                in<events::triggerCatMove,                actions::multiple<actions::executeCatMove, actions::broadcastState, actions::requestNextOperation>>,
-                in<events::triggerJanitorMove,            actions::multiple<actions::executeJanitorMove, actions::broadcastState, actions::requestNextOperation>>,
-                in<spy::network::messages::Hello,         actions::multiple<actions::HelloReply, actions::broadcastState>,                                                                                                                     guards::isSpectator>>;
+                in<events::triggerCatMove,                actions::multiple<actions::executeCatMove, actions::writeOperationEntry, actions::broadcastState, actions::requestNextOperation>>,
+                in<events::triggerJanitorMove,            actions::multiple<actions::executeJanitorMove, actions::writeOperationEntry, actions::broadcastState, actions::requestNextOperation>>,
+                in<spy::network::messages::Hello,         actions::multiple<actions::HelloReply, actions::sendCachedState>,                                                                                                                    guards::isSpectator>>;
                 // @formatter:on
             };
 
@@ -267,7 +264,8 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
                     spy::MatchConfig matchConfig = root_machine(fsm).matchConfig;
                     if (not serverEnforced and matchConfig.getPauseLimit().has_value()) {
                         spdlog::info("Starting pause timer for {} seconds", matchConfig.getPauseLimit().value());
-                        pauseLimitTimer.restart(std::chrono::seconds{matchConfig.getPauseLimit().value()}, [&fsm]() {
+                        pauseLimitTimer.restart(*root_machine(fsm).clock,
+                                                std::chrono::seconds{matchConfig.getPauseLimit().value()}, [&fsm]() {
                             spdlog::info("Pause time limit reached, unpausing.");
                             root_machine(fsm).process_event(events::forceUnpause{});
                         });
@@ -286,13 +284,13 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
                 // @formatter:off
                 using internal_transitions = transition_table <
                 // Event                              Action                                                                        Guard
-                in<spy::network::messages::Hello,     actions::multiple<actions::HelloReply, actions::broadcastState>,              guards::isSpectator>,
+                in<spy::network::messages::Hello,     actions::multiple<actions::HelloReply, actions::sendCachedState>,             guards::isSpectator>,
                 // Another player disconnects, stay in pause
                 in<events::playerDisconnect,          actions::startReconnectTimer>,
                 // A player reconnects, but one is still disconnected
-                in<spy::network::messages::Reconnect, actions::stopReconnectTimer,                                                  guards::bothDisconnected>,
+                in<spy::network::messages::Reconnect, actions::multiple<actions::stopReconnectTimer, actions::sendReconnectGameStart, actions::sendCachedGameStatus, actions::sendPendingOperationRequest>,                              guards::bothDisconnected>,
                 // A player reconnects, and before the disconnect(s) there was a normal pause which we have to continue
-                in<spy::network::messages::Reconnect, actions::multiple<actions::stopReconnectTimer, actions::revertToNormalPause>, and_<guards::pauseTimeRemaining, not_<guards::bothDisconnected>>>>;
+                in<spy::network::messages::Reconnect, actions::multiple<actions::stopReconnectTimer, actions::revertToNormalPause, actions::sendReconnectGameStart, actions::sendCachedGameStatus, actions::sendPendingOperationRequest>, and_<guards::pauseTimeRemaining, not_<guards::bothDisconnected>>>>;
                 // @formatter:on
             };
 
@@ -303,6 +301,8 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
             using transitions = transition_table <
             //  Start               Event                                     Next                 Action                                                                      Guard
             tr<roundInit,           events::roundInitDone,                    waitingForOperation, actions::multiple<actions::broadcastState, actions::requestNextOperation>>,
+            // Session restored after a restart, both players have to reconnect first
+            tr<roundInit,           events::restoreSession,                   paused,              actions::multiple<actions::pauseGame<true>, actions::restoreReconnectTimers>>,
             tr<waitingForOperation, events::roundDone,                        roundInit>,
             // Player requested pause
             tr<waitingForOperation, spy::network::messages::RequestGamePause, paused,              actions::pauseGame<false>,                                                  guards::isPauseRequest>,
@@ -313,7 +313,7 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
             // Force pause when player disconnects
             tr<waitingForOperation, events::playerDisconnect,                 paused,              actions::multiple<actions::pauseGame<true>, actions::startReconnectTimer>>,
             // Unpause if a player reconnects and not both players are disconnected and no pause time remaining
-            tr<paused,              spy::network::messages::Reconnect,        waitingForOperation, actions::multiple<actions::sendReconnectGameStart, actions::broadcastState, actions::unpauseGame, actions::requestNextOperation>, and_<not_<guards::pauseTimeRemaining>, not_<guards::bothDisconnected>>>
+            tr<paused,              spy::network::messages::Reconnect,        waitingForOperation, actions::multiple<actions::sendReconnectGameStart, actions::sendCachedGameStatus, actions::unpauseGame, actions::sendPendingOperationRequest, actions::resumeTurn>, and_<not_<guards::pauseTimeRemaining>, not_<guards::bothDisconnected>>>
             >;
             // @formatter:on
         };
@@ -329,7 +329,8 @@ class GameFSM : public afsm::def::state_machine<GameFSM> {
         using transitions = transition_table <
         // Start                  Event                                    Next        Action                                                                 Guard
         tr<decltype(choicePhase), spy::network::messages::ItemChoice,      equipPhase, actions::multiple<actions::handleChoice, actions::createCharacterSet>, and_<guards::lastChoice, guards::choiceValid>>,
-        tr<equipPhase,            spy::network::messages::EquipmentChoice, gamePhase,  actions::handleEquipmentChoice,                                        and_<guards::lastEquipmentChoice, guards::equipmentChoiceValid>>
+        tr<equipPhase,            spy::network::messages::EquipmentChoice, gamePhase,  actions::handleEquipmentChoice,                                        and_<guards::lastEquipmentChoice, guards::equipmentChoiceValid>>,
+        tr<decltype(choicePhase), events::restoreSession,                  gamePhase>
         >;
 
         using internal_transitions = transition_table <
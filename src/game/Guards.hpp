@@ -157,7 +157,8 @@ namespace guards {
         template<typename FSM, typename FSMState, typename Event>
         bool operator()(FSM const &fsm, FSMState const &, Event const &) {
             spdlog::debug("Testing GameOver condition");
-            return root_machine(fsm).isIngame && spy::util::RoundUtils::isGameOver(root_machine(fsm).gameState);
+            return root_machine(fsm).isIngame
+                   && root_machine(fsm).gameOverTracker.isGameOver(root_machine(fsm).gameState);
         }
     };
 
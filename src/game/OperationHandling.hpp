@@ -8,8 +8,11 @@
 #define SERVER017_OPERATIONHANDLING_HPP
 
 
+#include <set>
 #include <spdlog/spdlog.h>
 #include <network/messages/GameStatus.hpp>
+#include <network/messages/Hello.hpp>
+#include <network/messages/Reconnect.hpp>
 #include <network/messages/Strike.hpp>
 #include <util/RoundUtils.hpp>
 #include <gameLogic/generation/ActionGenerator.hpp>
@@ -18,6 +21,9 @@
 #include "util/Player.hpp"
 #include "util/Operation.hpp"
 #include "util/Util.hpp"
+#include "util/Timer.hpp"
+#include "network/AddressableFrame.hpp"
+#include "network/SpectatorThrottle.hpp"
 
 namespace actions {
     /**
@@ -40,7 +46,7 @@ namespace actions {
             const GameOperation &operationMessage = std::forward<GameOperation>(e);
 
             // update the state with the current players safe combination knowledge
-            auto activeCharacter = state.getCharacters().getByUUID(fsm.activeCharacter);
+            auto activeCharacter = root_machine(fsm).characterIndex.find(state.getCharacters(), fsm.activeCharacter);
 
             // Find player owning character
             std::optional<Player> player = std::nullopt;
@@ -60,8 +66,11 @@ namespace actions {
                              root_machine(fsm).strikeCounts[player.value()]);
                 root_machine(fsm).strikeCounts[player.value()] = 0;
                 state.setKnownSafeCombinations(knownCombinations.at(player.value()));
+                root_machine(fsm).statistics.turnFinished(player.value(), root_machine(fsm).clock->now());
             }
 
+            auto intelligencePointsBefore = static_cast<int>(activeCharacter->getIntelligencePoints());
+            auto firstExecuted = static_cast<std::ptrdiff_t>(fsm.operations.size());
             executeOperation(operationMessage.getOperation(),
                              state,
                              root_machine(fsm).matchConfig,
@@ -78,55 +87,133 @@ namespace actions {
             if (player.has_value()) {
                 // copy the potentially changed known combinations back to the map
                 knownCombinations[player.value()] = state.getMySafeCombinations();
+                root_machine(fsm).statistics.operationExecuted(
+                        player.value(), std::next(fsm.operations.cbegin(), firstExecuted), fsm.operations.cend(),
+                        static_cast<int>(activeCharacter->getIntelligencePoints()) - intelligencePointsBefore);
             }
+            root_machine(fsm).occupancy->update(state);
+            root_machine(fsm).gameOverTracker.update(state, fsm.operations);
         }
     };
 
+    /**
+     * @return True if the active character can't make another operation after the last one
+     */
+    template<typename Event, typename FSM>
+    bool turnEnded(const Event &event, FSM &fsm) {
+        if constexpr (std::is_same<Event, spy::network::messages::GameOperation>::value) {
+            const spy::network::messages::GameOperation &operation = event;
+            if (operation.getOperation()->getType() == spy::gameplay::OperationEnum::RETIRE) {
+                return true;
+            }
+        }
+        auto character = root_machine(fsm).characterIndex.find(root_machine(fsm).gameState.getCharacters(),
+                                                               fsm.activeCharacter);
+        return character == nullptr or not Util::hasAPMP(*character);
+    }
+
+    /**
+     * Serializes a GameStatus of the current state. The state is copied only once, into the message, and the
+     * serialized message is shared by all recipients of a broadcast: only the known safe combinations
+     * (setSafeCombinations) and the client id differ between them.
+     */
+    template<typename FSM>
+    nlohmann::json serializeGameStatus(FSM &fsm, const SpectatorThrottle::Operations &operations, bool gameOver) {
+        return spy::network::messages::GameStatus{
+                {}, // filled out per recipient
+                fsm.activeCharacter,
+                operations,
+                root_machine(fsm).gameState,
+                gameOver};
+    }
+
+    inline void setSafeCombinations(nlohmann::json &serializedStatus, const std::set<int> &combinations) {
+        serializedStatus.at("state").at("mySafeCombinations") = combinations;
+    }
+
+    /**
+     * Sends a serialized GameStatus to all spectators, without known safe combinations. The frame is kept for
+     * late joiners.
+     */
+    template<typename FSM>
+    void sendSpectatorState(FSM &fsm, nlohmann::json serializedStatus) {
+        MessageRouter &router = root_machine(fsm).router;
+
+        setSafeCombinations(serializedStatus, {});
+        AddressableFrame &spectatorFrame = root_machine(fsm).lastSpectatorStatus;
+        spectatorFrame = AddressableFrame{std::move(serializedStatus)};
+        if (not router.publishToSpectators(spectatorFrame)) {
+            for (const auto &[uuid, role] : root_machine(fsm).clientRoles) {
+                if (role == spy::network::RoleEnum::SPECTATOR) {
+                    router.sendRaw(uuid, spectatorFrame.addressedTo(uuid));
+                }
+            }
+        }
+    }
+
     /**
      * Broadcasts the current state to the players and the spectators. Spectators receive no information about
-     * the known safe combinations, the players receive their respective knowledge.
+     * the known safe combinations, the players receive their respective knowledge. Whether the spectators
+     * receive this update or a later one with all operations folded in is decided by the spectator throttle.
+     * The state is serialized once for the players and, if they receive the same operations, the spectators.
      */
     struct broadcastState {
         template<typename Event, typename FSM, typename SourceState, typename TargetState>
-        void operator()(Event &&, FSM &fsm, SourceState &, TargetState &) {
+        void operator()(Event &&event, FSM &fsm, SourceState &, TargetState &) {
             spdlog::info("Broadcasting state");
             MessageRouter &router = root_machine(fsm).router;
             const auto &playerIds = root_machine(fsm).playerIds;
-            const auto &clientRoles = root_machine(fsm).clientRoles;
+            bool gameOver = root_machine(fsm).gameOverTracker.isGameOver(root_machine(fsm).gameState);
+            auto serializedStatus = serializeGameStatus(fsm, fsm.operations, gameOver);
+
+            // players
+            for (const auto &player : {Player::one, Player::two}) {
+                setSafeCombinations(serializedStatus, root_machine(fsm).knownCombinations.at(player));
+                router.sendSerialized<spy::network::messages::GameStatus>(playerIds.at(player), serializedStatus);
+            }
 
             // spectators
-            spy::gameplay::State stateSpec = root_machine(fsm).gameState;
-            bool gameOver = spy::util::RoundUtils::isGameOver(stateSpec);
-            stateSpec.setKnownSafeCombinations({});
-            spy::network::messages::GameStatus messageSpec(
-                    {}, // filled out by the message router
-                    fsm.activeCharacter,
-                    fsm.operations,
-                    stateSpec,
-                    gameOver);
-
-            // send the spectator state to all spectators
-            for (const auto &[uuid, role] : clientRoles) {
-                if (role == spy::network::RoleEnum::SPECTATOR) {
-                    router.sendMessage(uuid, messageSpec);
+            SpectatorThrottle &throttle = root_machine(fsm).spectatorThrottle;
+            const SpectatorRelay *relay = router.getSpectatorRelay();
+            throttle.reportLoad(relay != nullptr ? relay->queueDepth() : 0);
+            if (throttle.update(fsm.operations, turnEnded(event, fsm), root_machine(fsm).clock->now())
+                or gameOver) {
+                auto spectatorOperations = throttle.takeOperations();
+                if (spectatorOperations == fsm.operations) {
+                    sendSpectatorState(fsm, std::move(serializedStatus));
+                } else {
+                    sendSpectatorState(fsm, serializeGameStatus(fsm, spectatorOperations, gameOver));
                 }
+            } else {
+                spdlog::debug("Spectator update withheld");
             }
 
-            // players
-            for (const auto &player : {Player::one, Player::two}) {
-                spy::gameplay::State state = root_machine(fsm).gameState;
-                state.setKnownSafeCombinations(root_machine(fsm).knownCombinations.at(player));
-                spy::network::messages::GameStatus message(
-                        playerIds.at(player),
-                        fsm.activeCharacter,
-                        fsm.operations,
-                        state,
-                        gameOver);
-
-                router.sendMessage(message);
+            root_machine(fsm).matchRecorder.addOperations(fsm.operations);
+            fsm.operations.clear();
+        }
+    };
+
+    /**
+     * Sends the spectator state of the last broadcast to a joining spectator only. The operations of the current
+     * turn are left untouched, they are part of the next broadcast.
+     */
+    struct sendCachedState {
+        template<typename Event, typename FSM, typename SourceState, typename TargetState>
+        void operator()(Event &&event, FSM &fsm, SourceState &, TargetState &) {
+            const spy::network::messages::Hello &helloMessage = event;
+            AddressableFrame &spectatorFrame = root_machine(fsm).lastSpectatorStatus;
+
+            if (spectatorFrame.empty()) {
+                // No broadcast in this game yet, send the current state without operations
+                auto serializedStatus = serializeGameStatus(
+                        fsm, {}, root_machine(fsm).gameOverTracker.isGameOver(root_machine(fsm).gameState));
+                setSafeCombinations(serializedStatus, {});
+                spectatorFrame = AddressableFrame{std::move(serializedStatus)};
             }
 
-            fsm.operations.clear();
+            spdlog::info("Sending cached state to spectator {}", helloMessage.getClientId());
+            root_machine(fsm).router.sendRaw(helloMessage.getClientId(),
+                                             spectatorFrame.addressedTo(helloMessage.getClientId()));
         }
     };
 
@@ -152,6 +239,58 @@ namespace actions {
         }
     };
 
+    /**
+     * Starts the turn phase timer (if the match configuration has a limit) for the operation requested from a
+     * player for the active character. If it expires, the player receives a strike and the operation is skipped.
+     */
+    template<typename FSM>
+    void startTurnPhaseTimer(FSM &fsm, Timer &timer, Player activePlayer) {
+        const spy::MatchConfig &matchConfig = root_machine(fsm).matchConfig;
+        if (matchConfig.getTurnPhaseLimit().has_value()) {
+            int turnPhaseLimitSeconds = matchConfig.getTurnPhaseLimit().value();
+            spdlog::info("Starting turn phase timer for {} seconds", turnPhaseLimitSeconds);
+            timer.restart(*root_machine(fsm).clock, std::chrono::seconds{turnPhaseLimitSeconds}, [
+                    &fsm = root_machine(fsm),
+                    player = *root_machine(fsm).playerIds.find(activePlayer),
+                    characterId = fsm.activeCharacter,
+                    strikeMax = static_cast<int>(matchConfig.getStrikeMaximum())]() {
+                spdlog::warn("Turn phase time limit reached for player {}.", player.first);
+                fsm.strikeCounts[player.first]++;
+                fsm.statistics.strikeIssued(player.first);
+                fsm.statistics.turnFinished(player.first, fsm.clock->now());
+                spy::network::messages::Strike strikeMessage{
+                        player.second,
+                        fsm.strikeCounts[player.first],
+                        strikeMax,
+                        "Turn phase time limit reached."};
+                spdlog::info("Sending strike nr. {} to player {}.", fsm.strikeCounts[player.first], player.first);
+                fsm.router.sendMessage(std::move(strikeMessage));
+
+                if (fsm.strikeCounts[player.first] == strikeMax) {
+                    spdlog::warn("Player {} has reached strike limit. Kicking player.", player.first);
+                    fsm.process_event(events::kickClient{player.second,
+                                                         spy::network::ErrorTypeEnum::TOO_MANY_STRIKES});
+                    return;
+                }
+
+                spy::gameplay::State &state = fsm.gameState;
+                auto character = fsm.characterIndex.find(state.getCharacters(), characterId);
+                if (character == nullptr) {
+                    spdlog::error("Character {} not found in characterset. Sending retire instead.", characterId);
+                    auto retireAction = std::make_shared<spy::gameplay::RetireAction>(characterId);
+                    spy::network::messages::GameOperation retireOp{player.second, retireAction};
+                    fsm.process_event(std::move(retireOp));
+                    return;
+                }
+
+                spdlog::info("Skipping operation.");
+                character->setActionPoints(0);
+                character->setMovePoints(0);
+                fsm.process_event(events::skipOperation{});
+            });
+        }
+    }
+
     /**
      * Chooses next Character and requests Operation.
      * Emits events::triggerNPCmove, triggerCatMove, triggerJanitorMove, roundDone
@@ -162,7 +301,7 @@ namespace actions {
             spdlog::info("RequestNextOperation: last active character was {}", fsm.activeCharacter);
             spy::gameplay::State &state = root_machine(fsm).gameState;
 
-            if (spy::util::RoundUtils::isGameOver(state)) {
+            if (root_machine(fsm).gameOverTracker.isGameOver(state)) {
                 // There may still be characters remaining, but the game has been won with the last action.
                 // We do not have to request a new operation, and abort early.
                 spdlog::info("Skipping requestNextOperation because game is already over.");
@@ -181,17 +320,18 @@ namespace actions {
 
             // Check if the next character has to be chosen or not
             bool advanceCharacter = true;
-            if (fsm.activeCharacter != spy::util::UUID{} and
-                state.getCharacters().findByUUID(fsm.activeCharacter) != state.getCharacters().end()) {
+            CharacterIndex &characterIndex = root_machine(fsm).characterIndex;
+            const spy::character::Character *activeCharacter = fsm.activeCharacter != spy::util::UUID{}
+                                                                ? characterIndex.find(state.getCharacters(),
+                                                                                      fsm.activeCharacter)
+                                                                : nullptr;
+            if (activeCharacter != nullptr) {
                 // Some character was already active this round
                 spdlog::debug("Last character was a regular character that might make another action");
 
-                const spy::character::Character &activeCharacter = *state.getCharacters().findByUUID(
-                        fsm.activeCharacter);
-
-                if (not isRetire and Util::hasAPMP(activeCharacter)) {
+                if (not isRetire and Util::hasAPMP(*activeCharacter)) {
                     spdlog::info("Character {} has not retired and can make another move.",
-                                 activeCharacter.getName());
+                                 activeCharacter->getName());
                     advanceCharacter = false;
                 }
             }
@@ -232,7 +372,7 @@ namespace actions {
             }
 
 
-            auto nextCharacter = state.getCharacters().getByUUID(fsm.activeCharacter);
+            auto nextCharacter = characterIndex.find(state.getCharacters(), fsm.activeCharacter);
             spdlog::info("Requesting operation from {}", nextCharacter->getName());
 
             // Determine which player the character belongs to
@@ -260,54 +400,67 @@ namespace actions {
                     fsm.activeCharacter
             };
             MessageRouter &router = root_machine(fsm).router;
+
+            // Spectators don't wait for withheld operations while the player is thinking
+            SpectatorThrottle &throttle = root_machine(fsm).spectatorThrottle;
+            if (throttle.flush(root_machine(fsm).clock->now())) {
+                sendSpectatorState(fsm, serializeGameStatus(fsm, throttle.takeOperations(), false));
+            }
+
             spdlog::info("Requesting Operation from player {}", activePlayer.value());
             router.sendMessage(request);
+            root_machine(fsm).statistics.operationRequested(activePlayer.value(), root_machine(fsm).clock->now());
 
-            const spy::MatchConfig &matchConfig = root_machine(fsm).matchConfig;
-            if (matchConfig.getTurnPhaseLimit().has_value()) {
-                int turnPhaseLimitSeconds = matchConfig.getTurnPhaseLimit().value();
-                spdlog::info("Starting turn phase timer for {} seconds", turnPhaseLimitSeconds);
-                target.turnPhaseTimer.restart(std::chrono::seconds{turnPhaseLimitSeconds}, [
-                        &fsm = root_machine(fsm),
-                        player = *root_machine(fsm).playerIds.find(activePlayer.value()),
-                        characterId = fsm.activeCharacter,
-                        strikeMax = static_cast<int>(matchConfig.getStrikeMaximum())]() {
-                    spdlog::warn("Turn phase time limit reached for player {}.", player.first);
-                    fsm.strikeCounts[player.first]++;
-                    spy::network::messages::Strike strikeMessage{
-                            player.second,
-                            fsm.strikeCounts[player.first],
-                            strikeMax,
-                            "Turn phase time limit reached."};
-                    spdlog::info("Sending strike nr. {} to player {}.", fsm.strikeCounts[player.first], player.first);
-                    fsm.router.sendMessage(std::move(strikeMessage));
-
-                    if (fsm.strikeCounts[player.first] == strikeMax) {
-                        spdlog::warn("Player {} has reached strike limit. Kicking player.", player.first);
-                        fsm.process_event(events::kickClient{player.second,
-                                                             spy::network::ErrorTypeEnum::TOO_MANY_STRIKES});
-                        return;
-                    }
-
-                    spy::gameplay::State &state = fsm.gameState;
-                    auto character = state.getCharacters().getByUUID(characterId);
-                    if (character == state.getCharacters().end()) {
-                        spdlog::error("Character {} not found in characterset. Sending retire instead.", characterId);
-                        auto retireAction = std::make_shared<spy::gameplay::RetireAction>(characterId);
-                        spy::network::messages::GameOperation retireOp{player.second, retireAction};
-                        fsm.process_event(std::move(retireOp));
-                        return;
-                    }
-
-                    spdlog::info("Skipping operation.");
-                    character->setActionPoints(0);
-                    character->setMovePoints(0);
-                    fsm.process_event(events::skipOperation{});
-                });
+            startTurnPhaseTimer(fsm, target.turnPhaseTimer, activePlayer.value());
+        }
+    };
+
+    /**
+     * Sends the last GameStatus to a reconnected player instead of broadcasting the state to all clients.
+     */
+    struct sendCachedGameStatus {
+        template<typename Event, typename FSM, typename SourceState, typename TargetState>
+        void operator()(const Event &event, FSM &fsm, SourceState &source, TargetState &target) {
+            const spy::network::messages::Reconnect &reconnectMessage = event;
+            if (not root_machine(fsm).router.resendLastGameStatus(reconnectMessage.getClientId())) {
+                spdlog::info("No GameStatus of {} cached, broadcasting state", reconnectMessage.getClientId());
+                broadcastState{}(event, fsm, source, target);
             }
         }
     };
 
+    /**
+     * Sends the operation request the reconnected player has not answered before the disconnect again.
+     */
+    struct sendPendingOperationRequest {
+        template<typename Event, typename FSM, typename SourceState, typename TargetState>
+        void operator()(const Event &event, FSM &fsm, SourceState &, TargetState &) {
+            const spy::network::messages::Reconnect &reconnectMessage = event;
+            if (root_machine(fsm).router.resendPendingOperationRequest(reconnectMessage.getClientId())) {
+                spdlog::info("Sent pending operation request to {} again", reconnectMessage.getClientId());
+            }
+        }
+    };
+
+    /**
+     * Continues the turn after the game was unpaused by a reconnect: the turn phase timer is restarted for the
+     * player whose operation request is pending, if no request is pending the next operation is requested.
+     */
+    struct resumeTurn {
+        template<typename Event, typename FSM, typename SourceState, typename TargetState>
+        void operator()(const Event &event, FSM &fsm, SourceState &source, TargetState &target) {
+            root_machine(fsm).statistics.gameResumed(root_machine(fsm).clock->now());
+            for (const auto &player : {Player::one, Player::two}) {
+                if (root_machine(fsm).router.hasPendingOperationRequest(root_machine(fsm).playerIds.at(player))) {
+                    spdlog::info("Resuming turn of player {}", player);
+                    startTurnPhaseTimer(fsm, target.turnPhaseTimer, player);
+                    return;
+                }
+            }
+            requestNextOperation{}(event, fsm, source, target);
+        }
+    };
+
     /**
      * @brief Generates and executes a cat movement
      */
@@ -327,6 +480,7 @@ namespace actions {
 
             auto res = ActionExecutor::executeCat(state, *std::dynamic_pointer_cast<const CatAction>(catAction));
             fsm.operations.push_back(res);
+            root_machine(fsm).occupancy->update(state);
         }
     };
 
@@ -341,28 +495,36 @@ namespace actions {
             using spy::gameplay::ActionExecutor;
             using spy::gameplay::ActionGenerator;
             using spy::gameplay::JanitorAction;
-            using spy::util::GameLogicUtils;
 
             State &state = root_machine(fsm).gameState;
 
             auto janitorAction = ActionGenerator::generateJanitorAction(state);
-            auto janitorTarget = GameLogicUtils::getInCharacterSetByCoordinates(state.getCharacters(),
-                                                                                janitorAction->getTarget());
+            auto targetId = root_machine(fsm).occupancy->characterAt(janitorAction->getTarget());
+            if (not targetId.has_value()) {
+                spdlog::critical("No character at the target of the janitor");
+                throw std::logic_error("No character at the target of the janitor");
+            }
 
             auto res = ActionExecutor::executeJanitor(state,
                                                       *std::dynamic_pointer_cast<const JanitorAction>(janitorAction));
+            root_machine(fsm).occupancy->update(state);
+            root_machine(fsm).characterIndex.rebuild(state.getCharacters());
+            root_machine(fsm).gameOverTracker.evaluate(state);
 
-            spdlog::debug("Janitor removes {}", janitorTarget->getName());
+            spdlog::debug("Janitor removes {}", targetId.value());
 
             fsm.operations.push_back(res);
 
-            // remove character from the list of remaining characters
-            auto it = std::find(fsm.remainingCharacters.begin(), fsm.remainingCharacters.end(),
-                                janitorTarget->getCharacterId());
+            // remove character from the list of remaining characters, the character may already have been erased
+            // from the character set by the janitor action
+            auto it = std::find(fsm.remainingCharacters.begin(), fsm.remainingCharacters.end(), targetId.value());
             if (it != fsm.remainingCharacters.end()) {
                 fsm.remainingCharacters.erase(it);
-                janitorTarget->setActionPoints(0);
-                janitorTarget->setMovePoints(0);
+                auto janitorTarget = root_machine(fsm).characterIndex.find(state.getCharacters(), targetId.value());
+                if (janitorTarget != nullptr) {
+                    janitorTarget->setActionPoints(0);
+                    janitorTarget->setMovePoints(0);
+                }
             }
         }
     };
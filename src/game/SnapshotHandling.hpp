@@ -0,0 +1,171 @@
+/**
+ * @file   SnapshotHandling.hpp
+ * @brief  Writing the session to the snapshot file and restoring it after a restart of the server.
+ */
+
+#ifndef SERVER017_SNAPSHOTHANDLING_HPP
+#define SERVER017_SNAPSHOTHANDLING_HPP
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <util/Player.hpp>
+#include <util/SnapshotLog.hpp>
+#include "Events.hpp"
+#include "Actions.hpp"
+
+namespace snapshot {
+    template<typename T>
+    nlohmann::json perPlayer(const std::map<Player, T> &values) {
+        nlohmann::json j = nlohmann::json::object();
+        for (const auto &[player, value] : values) {
+            j[player == Player::one ? "playerOne" : "playerTwo"] = value;
+        }
+        return j;
+    }
+
+    template<typename T>
+    std::map<Player, T> perPlayerFrom(const nlohmann::json &j) {
+        std::map<Player, T> values;
+        if (j.contains("playerOne")) {
+            values[Player::one] = j.at("playerOne").get<T>();
+        }
+        if (j.contains("playerTwo")) {
+            values[Player::two] = j.at("playerTwo").get<T>();
+        }
+        return values;
+    }
+
+    /**
+     * Parts of the session that may change with every operation.
+     * @param root      Server
+     * @param gamePhase GameFSM::gamePhase, holding the round order
+     */
+    template<typename Root, typename GamePhase>
+    nlohmann::json progress(const Root &root, const GamePhase &gamePhase) {
+        std::ostringstream rngState;
+        rngState << root.rng;
+
+        return {
+                {"entry",               SnapshotLog::operationEntry},
+                {"gameState",           root.gameState},
+                {"knownCombinations",   perPlayer(root.knownCombinations)},
+                {"strikeCounts",        perPlayer(root.strikeCounts)},
+                {"activeCharacter",     gamePhase.activeCharacter},
+                {"remainingCharacters", gamePhase.remainingCharacters},
+                {"rng",                 rngState.str()}
+        };
+    }
+
+    /**
+     * Whole session, sufficient to continue the game phase after a restart.
+     */
+    template<typename Root, typename GamePhase>
+    nlohmann::json checkpoint(const Root &root, const GamePhase &gamePhase) {
+        auto entry = progress(root, gamePhase);
+        entry["entry"] = SnapshotLog::checkpointEntry;
+        entry["sessionId"] = root.sessionId;
+        entry["playerIds"] = perPlayer(root.playerIds);
+        entry["playerNames"] = perPlayer(root.playerNames);
+        entry["catId"] = root.catId;
+        entry["janitorId"] = root.janitorId;
+        entry["characterInformations"] = root.characterInformations;
+
+        // Spectators are not restored, they have to connect again
+        std::map<spy::util::UUID, spy::network::RoleEnum> playerRoles;
+        for (const auto &[player, id] : root.playerIds) {
+            auto role = root.clientRoles.find(id);
+            if (role != root.clientRoles.end()) {
+                playerRoles.insert(*role);
+            }
+        }
+        entry["clientRoles"] = playerRoles;
+        return entry;
+    }
+
+    /**
+     * Writes a checkpoint if the snapshot file is enabled. The checkpoint replaces the entries of the last round,
+     * so the file doesn't grow with the length of the game.
+     * @param fsm GameFSM::gamePhase
+     */
+    template<typename FSM>
+    void writeCheckpoint(FSM &fsm) {
+        auto &log = root_machine(fsm).snapshotLog;
+        if (log.has_value()) {
+            log->compact(checkpoint(root_machine(fsm), fsm));
+        }
+    }
+
+    /**
+     * @return True if the event is the one used to restore a session from the snapshot file
+     */
+    template<typename Event>
+    constexpr bool isRestore() {
+        return std::is_same<std::decay_t<Event>, events::restoreSession>::value;
+    }
+}
+
+namespace actions {
+    /**
+     * Appends the progress of the game phase to the snapshot file (if enabled), before it is broadcast.
+     */
+    struct writeOperationEntry {
+        template<typename Event, typename FSM, typename SourceState, typename TargetState>
+        void operator()(Event &&, FSM &fsm, SourceState &, TargetState &) {
+            auto &log = root_machine(fsm).snapshotLog;
+            if (log.has_value()) {
+                log->append(snapshot::progress(root_machine(fsm), fsm));
+            }
+        }
+    };
+
+    /**
+     * Restores the session data of the server from the snapshot file, the round order is restored when entering
+     * the game phase.
+     */
+    struct restoreSession {
+        template<typename Event, typename FSM, typename SourceState, typename TargetState>
+        void operator()(Event &&, FSM &fsm, SourceState &, TargetState &) {
+            auto &root = root_machine(fsm);
+            const nlohmann::json &session = root.restoredSession.value();
+
+            root.sessionId = session.at("sessionId").template get<spy::util::UUID>();
+            root.playerIds = snapshot::perPlayerFrom<spy::util::UUID>(session.at("playerIds"));
+            root.playerNames = snapshot::perPlayerFrom<std::string>(session.at("playerNames"));
+            root.clientRoles = session.at("clientRoles")
+                    .template get<std::map<spy::util::UUID, spy::network::RoleEnum>>();
+            root.catId = session.at("catId").template get<spy::util::UUID>();
+            root.janitorId = session.at("janitorId").template get<spy::util::UUID>();
+            root.characterInformations = session.at("characterInformations")
+                    .template get<std::vector<spy::character::CharacterInformation>>();
+            root.payloadCache = PayloadCache{root.scenarioConfig, root.matchConfig, root.characterInformations};
+            root.gameState = session.at("gameState").template get<spy::gameplay::State>();
+            root.characterIndex.rebuild(root.gameState.getCharacters());
+            root.knownCombinations = snapshot::perPlayerFrom<std::set<int>>(session.at("knownCombinations"));
+            root.strikeCounts = snapshot::perPlayerFrom<int>(session.at("strikeCounts"));
+
+            std::istringstream rngState{session.at("rng").template get<std::string>()};
+            rngState >> root.rng;
+
+            spdlog::info("Restored session {} in round {}", root.sessionId, root.gameState.getCurrentRound());
+        }
+    };
+
+    /**
+     * Starts the reconnect timers for both players after a restored session, since neither is connected yet.
+     */
+    struct restoreReconnectTimers {
+        template<typename Event, typename FSM, typename SourceState, typename TargetState>
+        void operator()(Event &&, FSM &fsm, SourceState &source, TargetState &target) {
+            for (const auto &player : {Player::one, Player::two}) {
+                startReconnectTimer{}(events::playerDisconnect{root_machine(fsm).playerIds.at(player)}, fsm,
+                                      source, target);
+            }
+            root_machine(fsm).restoredSession.reset();
+        }
+    };
+}
+
+#endif //SERVER017_SNAPSHOTHANDLING_HPP
@@ -49,6 +49,7 @@ int main(int argc, char *argv[]) {
     }
 
     afsm::state_machine<Server> server(port, verbosity, characterPath, matchPath, scenarioPath, additionalOptions);
+    server.resumeSession();
 
     std::this_thread::sleep_until(
             std::chrono::system_clock::now() + std::chrono::hours(std::numeric_limits<int>::max()));
@@ -0,0 +1,64 @@
+/**
+ * @file   AddressableFrame.hpp
+ * @brief  Message serialized once and addressed to any number of clients afterwards.
+ */
+
+#ifndef SERVER017_ADDRESSABLE_FRAME_HPP
+#define SERVER017_ADDRESSABLE_FRAME_HPP
+
+#include <string>
+#include <nlohmann/json.hpp>
+#include <util/UUID.hpp>
+
+/**
+ * The message is serialized with a random placeholder as client id and split at the placeholder, so addressing
+ * the frame to a client only concatenates the parts with the serialized client id. The placeholder is set in the
+ * serialized message, the message itself is not copied.
+ */
+class AddressableFrame {
+    public:
+        AddressableFrame() = default;
+
+        template<typename MessageType>
+        explicit AddressableFrame(const MessageType &message) : AddressableFrame(nlohmann::json(message)) {}
+
+        /**
+         * Frame of a message serialized by the caller, the client id of the message is overwritten.
+         */
+        explicit AddressableFrame(nlohmann::json serializedMessage) {
+            auto placeholder = spy::util::UUID::generate();
+            serializedMessage["clientId"] = placeholder;
+            auto frame = serializedMessage.dump();
+
+            auto serializedPlaceholder = nlohmann::json(placeholder).dump();
+            auto position = frame.find(serializedPlaceholder);
+            if (position == std::string::npos) {
+                throw std::logic_error{"Serialized message does not contain the client id"};
+            }
+            prefix = frame.substr(0, position);
+            suffix = frame.substr(position + serializedPlaceholder.size());
+        }
+
+        [[nodiscard]] bool empty() const {
+            return prefix.empty();
+        }
+
+        /**
+         * @return The serialized message with the client id set to the given client
+         */
+        [[nodiscard]] std::string addressedTo(const spy::util::UUID &clientId) const {
+            auto serializedId = nlohmann::json(clientId).dump();
+            std::string frame;
+            frame.reserve(prefix.size() + serializedId.size() + suffix.size());
+            frame += prefix;
+            frame += serializedId;
+            frame += suffix;
+            return frame;
+        }
+
+    private:
+        std::string prefix;
+        std::string suffix;
+};
+
+#endif //SERVER017_ADDRESSABLE_FRAME_HPP
@@ -0,0 +1,44 @@
+/**
+ * @file   ForwardingListener.hpp
+ * @brief  Listener with a single subscriber that receives the arguments as they were passed.
+ */
+
+#ifndef SERVER017_FORWARDING_LISTENER_HPP
+#define SERVER017_FORWARDING_LISTENER_HPP
+
+#include <functional>
+#include <stdexcept>
+
+/**
+ * Replacement for websocket::util::Listener on the message path. websocket::util::Listener copies its arguments
+ * for every subscriber, this listener forwards them to its only subscriber, so arguments declared as reference
+ * (e.g. `Hello &&` or `const std::string &`) are neither copied nor moved on the way.
+ * @tparam Args Parameter types of the subscriber
+ */
+template<typename ...Args>
+class ForwardingListener {
+    public:
+        using Callback = std::function<void(Args...)>;
+
+        /**
+         * Sets the subscriber.
+         * @throws std::logic_error if the listener already has a subscriber
+         */
+        void subscribe(Callback newCallback) const {
+            if (callback) {
+                throw std::logic_error{"ForwardingListener already has a subscriber"};
+            }
+            callback = std::move(newCallback);
+        }
+
+        void operator()(Args ...args) const {
+            if (callback) {
+                callback(std::forward<Args>(args)...);
+            }
+        }
+
+    private:
+        mutable Callback callback;
+};
+
+#endif //SERVER017_FORWARDING_LISTENER_HPP
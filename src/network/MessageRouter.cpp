@@ -5,21 +5,46 @@
 #include "MessageRouter.hpp"
 #include "spdlog/fmt/ostr.h"
 #include "util/UUIDNotFoundException.hpp"
+#include "transport/WebSocketTransport.hpp"
 
-MessageRouter::MessageRouter(uint16_t port, std::string protocol) : server{port, std::move(protocol)} {
-    server.connectionListener.subscribe(
+const std::array<MessageRouter::Dispatch, inbound::Messages::tableSize> MessageRouter::dispatchTable =
+        MessageRouter::makeDispatchTable(inbound::Messages{});
+
+MessageRouter::MessageRouter(uint16_t port, std::string protocol) :
+        MessageRouter{std::make_shared<transport::WebSocketTransport>(port, std::move(protocol))} {}
+
+MessageRouter::MessageRouter(std::shared_ptr<transport::Transport> transport) {
+    addTransport(std::move(transport));
+}
+
+void MessageRouter::addTransport(std::shared_ptr<transport::Transport> transport) {
+    transport->connectionListener.subscribe(
             [this](const connectionPtr &newConnection) {
                 connectListener(newConnection);
             });
-    server.closeListener.subscribe(
+    transport->closeListener.subscribe(
             [this](const connectionPtr &closedConnection) {
                 disconnectListener(closedConnection);
             });
+    transports.push_back(std::move(transport));
+}
+
+const std::vector<std::shared_ptr<transport::Transport>> &MessageRouter::getTransports() const {
+    return transports;
+}
+
+void MessageRouter::setRoleProvider(
+        std::function<std::optional<spy::network::RoleEnum>(const spy::util::UUID &)> provider) {
+    roleProvider = std::move(provider);
 }
 
 void MessageRouter::connectListener(const MessageRouter::connectionPtr &newConnection) {
     spdlog::info("New client connected");
 
+    if (capture) {
+        capture->recordConnect(newConnection);
+    }
+
     // Connection does not have UUID yet
     activeConnections.emplace_back(newConnection, std::nullopt);
 
@@ -30,11 +55,21 @@ void MessageRouter::connectListener(const MessageRouter::connectionPtr &newConne
 
 void MessageRouter::disconnectListener(const MessageRouter::connectionPtr &closedConnection) {
     spdlog::info("Router: client disconnect");
+    if (capture) {
+        capture->recordClose(closedConnection);
+    }
+    unrelay(closedConnection);
+
     std::optional<spy::util::UUID> connectionUUID;
     try {
         const auto &foundConnection = connectionFromPtr(closedConnection);
         connectionUUID = foundConnection.second;
     } catch (const std::invalid_argument &e) {
+        retiredConnections.erase(std::remove_if(retiredConnections.begin(), retiredConnections.end(),
+                                                [&closedConnection](const auto &c) {
+                                                    return c.first == closedConnection;
+                                                }),
+                                 retiredConnections.end());
         spdlog::info("Not registered connection closed. (Exception: {})", e.what());
         return;
     }
@@ -61,12 +96,24 @@ void MessageRouter::disconnectListener(const MessageRouter::connectionPtr &close
 }
 
 void MessageRouter::receiveListener(const MessageRouter::connectionPtr &connectionPtr, const std::string &message) {
+    if (capture) {
+        capture->recordMessage(connectionPtr, message);
+    }
+
     std::optional<spy::util::UUID> connectionId = std::nullopt;
     try {
         const auto &con = connectionFromPtr(connectionPtr);
         connectionId = con.second;
     } catch (const std::invalid_argument &) {
-        spdlog::warn("Received message from kicked client");
+        auto retired = std::find_if(retiredConnections.begin(), retiredConnections.end(),
+                                    [&connectionPtr](const auto &c) {
+                                        return c.first == connectionPtr;
+                                    });
+        if (retired != retiredConnections.end()) {
+            retiredReceiveListener(*retired, message);
+        } else {
+            spdlog::warn("Received message from kicked client");
+        }
         return;
     }
 
@@ -76,9 +123,19 @@ void MessageRouter::receiveListener(const MessageRouter::connectionPtr &connecti
         messageJson = nlohmann::json::parse(message);
         auto messageContainer = messageJson.get<spy::network::MessageContainer>();
 
-        //check if client sends with his own UUID
-        if (messageContainer.getType() != spy::network::messages::MessageTypeEnum::HELLO
-            and messageContainer.getType() != spy::network::messages::MessageTypeEnum::RECONNECT) {
+        auto typeIndex = static_cast<std::size_t>(messageContainer.getType());
+        if (messageContainer.getType() == spy::network::messages::MessageTypeEnum::INVALID) {
+            spdlog::error("Received message with invalid type: " + message);
+            return;
+        }
+        if (typeIndex >= dispatchTable.size() or dispatchTable.at(typeIndex).decode == nullptr) {
+            spdlog::error("Handling this message type has not been implemented.");
+            return;
+        }
+        const auto &dispatch = dispatchTable.at(typeIndex);
+
+        // The role is checked before the message is decoded
+        if ((dispatch.roles & inbound::unassigned) == 0) {
             // All messages other than HELLO and RECONNECT require that the client is already registered.
             // -> connectionId should have been found and be equal to clientId in message.
 
@@ -94,51 +151,23 @@ void MessageRouter::receiveListener(const MessageRouter::connectionPtr &connecti
                              messageContainer.getClientId());
                 messageJson.at("clientId") = connectionId.value(); // correct the uuid
             }
-        }
 
-        switch (messageContainer.getType()) {
-            case spy::network::messages::MessageTypeEnum::INVALID:
-                spdlog::error("Received message with invalid type: " + message);
-                return;
-            case spy::network::messages::MessageTypeEnum::HELLO:
-                spdlog::debug("MessageRouter received Hello message.");
-                helloListener(messageJson.get<spy::network::messages::Hello>(), connectionPtr);
-                return;
-            case spy::network::messages::MessageTypeEnum::RECONNECT:
-                spdlog::debug("MessageRouter received Reconnect message.");
-                reconnectListener(messageJson.get<spy::network::messages::Reconnect>(), connectionPtr);
-                return;
-            case spy::network::messages::MessageTypeEnum::ITEM_CHOICE:
-                spdlog::debug("MessageRouter received ItemChoice message.");
-                itemChoiceListener(messageJson.get<spy::network::messages::ItemChoice>());
-                return;
-            case spy::network::messages::MessageTypeEnum::EQUIPMENT_CHOICE:
-                spdlog::debug("MessageRouter received EquipmentChoice message.");
-                equipmentChoiceListener(messageJson.get<spy::network::messages::EquipmentChoice>());
+            auto role = roleProvider ? roleProvider(connectionId.value()) : std::nullopt;
+            if (not role.has_value()) {
+                spdlog::warn("Client {} without role sent a {} message, dropping it.", connectionId.value(),
+                             messageJson.at("type").dump());
                 return;
-            case spy::network::messages::MessageTypeEnum::GAME_OPERATION:
-                spdlog::debug("MessageRouter received GameOperation message.");
-                gameOperationListener(messageJson.get<spy::network::messages::GameOperation>());
-                return;
-            case spy::network::messages::MessageTypeEnum::GAME_LEAVE:
-                spdlog::info("MessageRouter received GameLeave message.");
-                gameLeaveListener(messageJson.get<spy::network::messages::GameLeave>());
-                return;
-            case spy::network::messages::MessageTypeEnum::REQUEST_GAME_PAUSE:
-                spdlog::debug("MessageRouter received RequestGamePause message.");
-                pauseRequestListener(messageJson.get<spy::network::messages::RequestGamePause>());
-                return;
-            case spy::network::messages::MessageTypeEnum::REQUEST_META_INFORMATION:
-                spdlog::debug("MessageRouter received RequestMetaInformation message.");
-                metaInformationRequestListener(messageJson.get<spy::network::messages::RequestMetaInformation>());
-                return;
-            case spy::network::messages::MessageTypeEnum::REQUEST_REPLAY:
-                spdlog::debug("MessageRouter received RequestReplay message.");
-                replayRequestListener(messageJson.get<spy::network::messages::RequestReplay>());
+            }
+            if ((dispatch.roles & inbound::maskOf(role.value())) == 0) {
+                spdlog::warn("Client {} sent a {} message that was rejected due to role filtering",
+                             connectionId.value(), messageJson.at("type").dump());
+                illegalMessageListener(connectionId.value(), messageContainer.getType());
                 return;
-            default:
-                spdlog::error("Handling this message type has not been implemented.");
+            }
         }
+
+        spdlog::debug("MessageRouter received {} message.", messageJson.at("type").dump());
+        dispatch.decode(*this, messageJson, connectionPtr);
     } catch (nlohmann::json::exception &e) {
         // message doesn't fit to the standard definition --> illegal message error + kick
         spdlog::error("Error parsing JSON from message: {}", e.what());
@@ -158,6 +187,38 @@ void MessageRouter::receiveListener(const MessageRouter::connectionPtr &connecti
     }
 }
 
+void MessageRouter::retiredReceiveListener(const connection &retiredConnection, const std::string &message) {
+    try {
+        auto messageJson = nlohmann::json::parse(message);
+        auto messageContainer = messageJson.get<spy::network::MessageContainer>();
+        if (messageContainer.getType() != spy::network::messages::MessageTypeEnum::REQUEST_REPLAY) {
+            spdlog::warn("Received message of type {} from client {} of the last game, dropping it.",
+                         messageJson.at("type").dump(), retiredConnection.second.value());
+            return;
+        }
+        messageJson.at("clientId") = retiredConnection.second.value();
+        spdlog::debug("MessageRouter received RequestReplay message from client of the last game.");
+        using spy::network::messages::RequestReplay;
+        std::get<MessageListener<RequestReplay>>(messageListeners)(messageJson.get<RequestReplay>(),
+                                                                   retiredConnection.first);
+    } catch (nlohmann::json::exception &e) {
+        spdlog::error("Error parsing JSON from client of the last game: {}", e.what());
+    }
+}
+
+void MessageRouter::sendRaw(const spy::util::UUID &client, const std::string &message) {
+    for (const auto *connections : {&activeConnections, &retiredConnections}) {
+        for (const auto &[ptr, id] : *connections) {
+            if (id == client) {
+                spdlog::trace("Sending message: {}", message);
+                deliver(ptr, message);
+                return;
+            }
+        }
+    }
+    spdlog::warn("Tried sending message to UUID {}, but it's not found in connection list.", client);
+}
+
 void
 MessageRouter::registerUUIDforConnection(const spy::util::UUID &id, const MessageRouter::connectionPtr &connection) {
     try {
@@ -187,6 +248,15 @@ MessageRouter::connection &MessageRouter::connectionFromUUID(const spy::util::UU
 }
 
 void MessageRouter::clearConnections() {
+    lastGameStatus.clear();
+    pendingOperationRequests.clear();
+    retiredConnections.clear();
+    for (auto &c : activeConnections) {
+        unrelay(c.first);
+        if (c.second.has_value()) {
+            retiredConnections.push_back(std::move(c));
+        }
+    }
     activeConnections.clear();
 }
 
@@ -194,6 +264,7 @@ void MessageRouter::closeConnection(const spy::util::UUID &id) {
     spdlog::info("MessageRouter: Closing connection to player {}", id);
     try {
         connection con = connectionFromUUID(id);
+        unrelay(con.first);
         activeConnections.erase(std::remove(activeConnections.begin(), activeConnections.end(), con),
                                 activeConnections.end());
     } catch (const UUIDNotFoundException &e) {
@@ -209,3 +280,74 @@ bool MessageRouter::isConnected(const spy::util::UUID &id) const {
 
     return r != activeConnections.end();
 }
+
+bool MessageRouter::resendLastGameStatus(const spy::util::UUID &client) {
+    auto status = lastGameStatus.find(client);
+    if (status == lastGameStatus.end()) {
+        return false;
+    }
+    sendRaw(client, status->second);
+    return true;
+}
+
+bool MessageRouter::resendPendingOperationRequest(const spy::util::UUID &client) {
+    auto request = pendingOperationRequests.find(client);
+    if (request == pendingOperationRequests.end()) {
+        return false;
+    }
+    sendRaw(client, request->second);
+    return true;
+}
+
+bool MessageRouter::hasPendingOperationRequest(const spy::util::UUID &client) const {
+    return pendingOperationRequests.find(client) != pendingOperationRequests.end();
+}
+
+void MessageRouter::startSpectatorRelay(unsigned int threads) {
+    spectatorRelay = std::make_unique<SpectatorRelay>(threads);
+    spdlog::info("Spectators are served by a relay with {} threads", threads);
+}
+
+void MessageRouter::relaySpectator(const spy::util::UUID &client) {
+    if (not spectatorRelay) {
+        return;
+    }
+    try {
+        const auto &con = connectionFromUUID(client);
+        spectatorRelay->add(con.first, client);
+        relayedConnections.insert(con.first);
+    } catch (const UUIDNotFoundException &) {
+        spdlog::warn("Spectator {} is not connected, can not hand it over to the relay", client);
+    }
+}
+
+bool MessageRouter::publishToSpectators(const AddressableFrame &frame) {
+    if (not spectatorRelay) {
+        return false;
+    }
+    spectatorRelay->publish(std::make_shared<const AddressableFrame>(frame));
+    return true;
+}
+
+const SpectatorRelay *MessageRouter::getSpectatorRelay() const {
+    return spectatorRelay.get();
+}
+
+void MessageRouter::deliver(const connectionPtr &connection, const std::string &frame) {
+    if (spectatorRelay and relayedConnections.find(connection) != relayedConnections.end()) {
+        spectatorRelay->send(connection, frame);
+    } else {
+        connection->send(frame);
+    }
+}
+
+void MessageRouter::unrelay(const connectionPtr &connection) {
+    if (relayedConnections.erase(connection) > 0) {
+        spectatorRelay->remove(connection);
+    }
+}
+
+void MessageRouter::startCapture(const std::string &path, unsigned int seed) {
+    capture = std::make_unique<TrafficCapture>(path, seed);
+    spdlog::info("Capturing inbound traffic to {} (seed {})", path, seed);
+}
@@ -2,87 +2,91 @@
 #define SERVER017_MESSAGEROUTER_HPP
 
 #include <nlohmann/json.hpp>
-#include <Server/WebSocketServer.hpp>
+#include <Util/Listener.hpp>
 #include <utility>
 #include <spdlog/spdlog.h>
+#include <array>
+#include <functional>
+#include <map>
 #include <set>
-#include <network/messages/Hello.hpp>
-#include <network/messages/Reconnect.hpp>
-#include <network/messages/ItemChoice.hpp>
-#include <network/messages/EquipmentChoice.hpp>
-#include <network/messages/GameOperation.hpp>
-#include <network/messages/GameLeave.hpp>
-#include <network/messages/RequestGamePause.hpp>
-#include <network/messages/RequestMetaInformation.hpp>
-#include <network/messages/RequestReplay.hpp>
+#include <tuple>
+#include <network/messages/GameStatus.hpp>
+#include <network/messages/RequestGameOperation.hpp>
+#include <network/messages/RequestItemChoice.hpp>
 #include <util/UUIDNotFoundException.hpp>
+#include "transport/Transport.hpp"
+#include "TrafficCapture.hpp"
+#include "SpectatorRelay.hpp"
+#include "AddressableFrame.hpp"
+#include "ForwardingListener.hpp"
+#include "MessageTypeTraits.hpp"
 
 /**
- * The MessageRouter holds a websocket::network::WebSocketServer and manages and enumerates connections.
+ * The MessageRouter holds one or more transports (by default a websocket::network::WebSocketServer) and manages
+ * and enumerates the connections of all of them.
  */
 class MessageRouter {
     public:
-        using connectionPtr = std::shared_ptr<websocket::network::Connection>;
+        using connectionPtr = transport::Transport::connectionPtr;
         using connection = std::pair<connectionPtr, std::optional<spy::util::UUID>>;
         using connectionMap = std::vector<connection>;
 
+        /**
+         * Creates a router accepting websocket connections.
+         */
         MessageRouter(uint16_t port, std::string protocol);
 
+        /**
+         * Creates a router accepting connections from the given transport.
+         */
+        explicit MessageRouter(std::shared_ptr<transport::Transport> transport);
+
+        /**
+         * Accepts connections from an additional transport, e.g. a unix socket for local clients.
+         */
+        void addTransport(std::shared_ptr<transport::Transport> transport);
+
+        [[nodiscard]] const std::vector<std::shared_ptr<transport::Transport>> &getTransports() const;
+
+        /**
+         * Sends a message to all registered clients. The message is serialized once and addressed per client.
+         */
         template<typename MessageType>
-        void broadcastMessage(MessageType message) {
+        void broadcastMessage(const MessageType &message) {
+            AddressableFrame frame{message};
             for (const auto &[ptr, uuid] :activeConnections) {
                 if (!uuid.has_value()) {
                     spdlog::warn("Broadcasting message while there is unregistered connection");
                     continue;
                 }
-                sendMessage(uuid.value(), message);
+                sendFrame<MessageType>(uuid.value(), frame.addressedTo(uuid.value()));
             }
         }
 
-        template<typename T>
-        void addHelloListener(T l) {
-            helloListener.subscribe(l);
-        }
-
-        template<typename T>
-        void addReconnectListener(T l) {
-            reconnectListener.subscribe(l);
-        }
-
-        template<typename T>
-        void addItemChoiceListener(T l) {
-            itemChoiceListener.subscribe(l);
-        }
-
-        template<typename T>
-        void addEquipmentChoiceListener(T l) {
-            equipmentChoiceListener.subscribe(l);
-        }
-
-        template<typename T>
-        void addGameOperationListener(T l) {
-            gameOperationListener.subscribe(l);
-        }
-
-        template<typename T>
-        void addGameLeaveListener(T l) {
-            gameLeaveListener.subscribe(l);
-        }
-
-        template<typename T>
-        void addPauseRequestListener(T l) {
-            pauseRequestListener.subscribe(l);
+        /**
+         * Subscribes to the inbound messages of a type listed in inbound::Messages. The listener is called with
+         * the decoded message (as rvalue reference) and the connection it was received on.
+         */
+        template<typename MessageType, typename T>
+        void addListener(T l) {
+            std::get<MessageListener<MessageType>>(messageListeners).subscribe(std::move(l));
         }
 
+        /**
+         * Subscribes to messages rejected because the role of the sender may not send them, the listener is called
+         * with the client and the type of the message.
+         */
         template<typename T>
-        void addMetaInformationRequestListener(T l) {
-            metaInformationRequestListener.subscribe(l);
+        void addIllegalMessageListener(T l) {
+            illegalMessageListener.subscribe(std::move(l));
         }
 
-        template<typename T>
-        void addReplayRequestListener(T l) {
-            replayRequestListener.subscribe(l);
-        }
+        /**
+         * Sets the function providing the role of a registered client (std::nullopt if unknown). Messages are
+         * checked against the roles allowed by inbound::Messages before they are decoded, messages of clients
+         * without role are dropped unless they may be sent by unassigned clients.
+         */
+        void setRoleProvider(std::function<std::optional<spy::network::RoleEnum>(const spy::util::UUID &)> provider);
 
         template<typename T>
         void addDisconnectListener(T l) {
@@ -94,44 +98,53 @@ class MessageRouter {
 
         /**
          * Sends a message to a specific client.
-         * Message field MessageContainer::clientId will be set to the value of \p client
+         * Field clientId of the serialized message will be set to the value of \p client, the message itself is
+         * not copied to change it.
          * @param client message recipient
          */
         template<typename MessageType>
-        void sendMessage(spy::util::UUID client, MessageType message) {
-            message.setClientId(client);
-            sendMessage(message);
+        void sendMessage(const spy::util::UUID &client, const MessageType &message) {
+            nlohmann::json serializedMessage = message;
+            sendSerialized<MessageType>(client, serializedMessage);
+        }
+
+        /**
+         * Sends a message serialized by the caller to a specific client, e.g. one serialized once and patched for
+         * several recipients. Field clientId of \p serializedMessage is set to the value of \p client.
+         * @tparam MessageType Type of the serialized message
+         */
+        template<typename MessageType>
+        void sendSerialized(const spy::util::UUID &client, nlohmann::json &serializedMessage) {
+            serializedMessage["clientId"] = client;
+            sendFrame<MessageType>(client, serializedMessage.dump());
         }
 
         /**
          * Sends a message to the client specified in the message
          */
         template<typename MessageType>
-        void sendMessage(MessageType message) {
-            try {
-                auto &con = connectionFromUUID(message.getClientId());
-                sendMessage(con.first, message);
-            } catch (const UUIDNotFoundException &e) {
-                spdlog::warn("UUIDNotFoundException: {}", e.what());
-                spdlog::warn("Tried sending message to UUID {}, but it's not found in connection list.",
-                             message.getClientId());
-                spdlog::debug("Active connections: ");
-                for (const auto &[_, optID]: activeConnections) {
-                    spdlog::debug(optID.value_or(spy::util::UUID{}));
-                }
-            }
+        void sendMessage(const MessageType &message) {
+            nlohmann::json serializedMessage = message;
+            sendFrame<MessageType>(message.getClientId(), serializedMessage.dump());
         }
 
         /**
          * Sends a message to a specific connection.
          */
         template<typename MessageType>
-        void sendMessage(connectionPtr connectionPtr, MessageType message) {
+        void sendMessage(const connectionPtr &connection, const MessageType &message) {
             nlohmann::json serializedMessage = message;
-            spdlog::trace("Sending message: {}", serializedMessage.dump());
-            connectionPtr->send(serializedMessage.dump());
+            auto frame = serializedMessage.dump();
+            spdlog::trace("Sending message: {}", frame);
+            deliver(connection, frame);
+            keepForReconnect<MessageType>(message.getClientId(), std::move(frame));
         }
 
+        /**
+         * Sends an already serialized message to a specific client, which may also be a retired client.
+         */
+        void sendRaw(const spy::util::UUID &client, const std::string &message);
+
         /**
          * Assigns a UUID to a specific connection
          * @param id         UUID of client
@@ -139,18 +152,139 @@ class MessageRouter {
          */
         void registerUUIDforConnection(const spy::util::UUID &id, const connectionPtr &connection);
 
+        /**
+         * Removes all connections. Registered connections are kept as retired connections until the next call,
+         * retired clients may only request the replay of the finished game.
+         */
         void clearConnections();
 
         void closeConnection(const spy::util::UUID &id);
 
+        /**
+         * Sends the last GameStatus sent to the client again, e.g. after it reconnected.
+         * @return False if the client has not received a GameStatus since the connections were cleared
+         */
+        bool resendLastGameStatus(const spy::util::UUID &client);
+
+        /**
+         * Sends the RequestGameOperation the client has not answered yet (no GameStatus was sent to it since)
+         * again, if there is one.
+         * @return True if a request was pending
+         */
+        bool resendPendingOperationRequest(const spy::util::UUID &client);
+
+        [[nodiscard]] bool hasPendingOperationRequest(const spy::util::UUID &client) const;
+
+        /**
+         * Sends all frames to spectators from now on via a SpectatorRelay with the given number of threads.
+         */
+        void startSpectatorRelay(unsigned int threads);
+
+        /**
+         * Hands the connection of a spectator over to the relay, if the relay is running.
+         */
+        void relaySpectator(const spy::util::UUID &client);
+
+        /**
+         * Sends a frame to all relayed spectators. The frame is handed to the relay once, addressing and
+         * sending happens on the relay threads.
+         * @return False if the relay is not running, the caller has to send the frame itself
+         */
+        bool publishToSpectators(const AddressableFrame &frame);
+
+        /**
+         * @return The relay or nullptr if it is not running
+         */
+        [[nodiscard]] const SpectatorRelay *getSpectatorRelay() const;
+
+        /**
+         * Records all inbound traffic and the item offers from now on to the given file.
+         * @param seed Seed of the random numbers of the server, needed to replay the capture
+         * @throws std::runtime_error if the file can not be opened
+         */
+        void startCapture(const std::string &path, unsigned int seed);
+
     private:
-        websocket::network::WebSocketServer server;
+        std::vector<std::shared_ptr<transport::Transport>> transports;
+
+        // Last GameStatus and unanswered RequestGameOperation of every client, serialized
+        std::map<spy::util::UUID, std::string> lastGameStatus;
+        std::map<spy::util::UUID, std::string> pendingOperationRequests;
+
+        // Only set if spectators are served by the relay, relayedConnections are the connections handed over
+        std::unique_ptr<SpectatorRelay> spectatorRelay;
+        std::set<connectionPtr> relayedConnections;
+
+        // Only set if the traffic is captured
+        std::unique_ptr<TrafficCapture> capture;
 
         // Active connections, including spectators.
         connectionMap activeConnections;
 
+        // Connections of the last game, only used to answer replay requests.
+        connectionMap retiredConnections;
+
         connection &connectionFromPtr(const connectionPtr &con);
 
+        /**
+         * Sends a frame directly or via the spectator relay if the connection has been handed over to it.
+         */
+        void deliver(const connectionPtr &connection, const std::string &frame);
+
+        /**
+         * Sends a serialized message of the given type to a registered client.
+         */
+        template<typename MessageType>
+        void sendFrame(const spy::util::UUID &client, std::string frame) {
+            try {
+                auto &con = connectionFromUUID(client);
+                spdlog::trace("Sending message: {}", frame);
+                deliver(con.first, frame);
+                captureSent<MessageType>(con.first, frame);
+                keepForReconnect<MessageType>(client, std::move(frame));
+            } catch (const UUIDNotFoundException &e) {
+                spdlog::warn("UUIDNotFoundException: {}", e.what());
+                spdlog::warn("Tried sending message to UUID {}, but it's not found in connection list.", client);
+                spdlog::debug("Active connections: ");
+                for (const auto &[_, optID]: activeConnections) {
+                    spdlog::debug(optID.value_or(spy::util::UUID{}));
+                }
+            }
+        }
+
+        /**
+         * Keeps what a reconnecting player needs to continue: the last GameStatus and the unanswered
+         * RequestGameOperation.
+         */
+        template<typename MessageType>
+        void keepForReconnect(const spy::util::UUID &client, std::string frame) {
+            using spy::network::messages::GameStatus;
+            using spy::network::messages::RequestGameOperation;
+            if constexpr (std::is_same<MessageType, GameStatus>::value) {
+                pendingOperationRequests.erase(client);
+                lastGameStatus[client] = std::move(frame);
+            } else if constexpr (std::is_same<MessageType, RequestGameOperation>::value) {
+                pendingOperationRequests[client] = std::move(frame);
+            }
+        }
+
+        /**
+         * Captures the item offers, a replay maps the captured choices to its own offers by their index.
+         */
+        template<typename MessageType>
+        void captureSent(const connectionPtr &connection, const std::string &frame) {
+            if constexpr (std::is_same<MessageType, spy::network::messages::RequestItemChoice>::value) {
+                if (capture) {
+                    capture->recordSent(connection, frame);
+                }
+            }
+        }
+
+        /**
+         * Takes a connection back from the spectator relay, e.g. when it is closed.
+         */
+        void unrelay(const connectionPtr &connection);
+
         connection &connectionFromUUID(const spy::util::UUID &id);
 
         /**
@@ -168,15 +302,56 @@ class MessageRouter {
          */
         void receiveListener(const connectionPtr &connection, const std::string &message);
 
-        const websocket::util::Listener<spy::network::messages::Hello, connectionPtr> helloListener;
-        const websocket::util::Listener<spy::network::messages::Reconnect, connectionPtr> reconnectListener;
-        const websocket::util::Listener<spy::network::messages::ItemChoice> itemChoiceListener;
-        const websocket::util::Listener<spy::network::messages::EquipmentChoice> equipmentChoiceListener;
-        const websocket::util::Listener<spy::network::messages::GameOperation> gameOperationListener;
-        const websocket::util::Listener<spy::network::messages::GameLeave> gameLeaveListener;
-        const websocket::util::Listener<spy::network::messages::RequestGamePause> pauseRequestListener;
-        const websocket::util::Listener<spy::network::messages::RequestMetaInformation> metaInformationRequestListener;
-        const websocket::util::Listener<spy::network::messages::RequestReplay> replayRequestListener;
+        /**
+         * Handles a message from a retired connection, only replay requests are accepted.
+         */
+        void retiredReceiveListener(const connection &retiredConnection, const std::string &message);
+
+        template<typename MessageType>
+        using MessageListener = ForwardingListener<MessageType &&, const connectionPtr &>;
+
+        template<typename List>
+        struct ListenersOf;
+
+        template<typename ...Entries>
+        struct ListenersOf<inbound::MessageList<Entries...>> {
+            using type = std::tuple<MessageListener<typename Entries::type>...>;
+        };
+
+        // One listener per inbound message type, decoded messages are moved through to the subscriber
+        const ListenersOf<inbound::Messages>::type messageListeners;
+
+        const ForwardingListener<const spy::util::UUID &,
+                                 spy::network::messages::MessageTypeEnum> illegalMessageListener;
+        std::function<std::optional<spy::network::RoleEnum>(const spy::util::UUID &)> roleProvider;
+
+        /**
+         * Entry of the dispatch table, indexed by the message type.
+         */
+        struct Dispatch {
+            void (*decode)(MessageRouter &router, const nlohmann::json &messageJson,
+                           const connectionPtr &connection) = nullptr;
+            inbound::RoleMask roles = 0;
+        };
+
+        template<typename Entry>
+        static void decodeAndDispatch(MessageRouter &router, const nlohmann::json &messageJson,
+                                      const connectionPtr &connection) {
+            using MessageType = typename Entry::type;
+            std::get<MessageListener<MessageType>>(router.messageListeners)(messageJson.get<MessageType>(),
+                                                                            connection);
+        }
+
+        template<typename ...Entries>
+        static constexpr auto makeDispatchTable(inbound::MessageList<Entries...>) {
+            std::array<Dispatch, inbound::MessageList<Entries...>::tableSize> table{};
+            ((table[static_cast<std::size_t>(Entries::typeEnum)] = Dispatch{&decodeAndDispatch<Entries>,
+                                                                             Entries::roles}), ...);
+            return table;
+        }
+
+        // Generated from inbound::Messages at compile time
+        static const std::array<Dispatch, inbound::Messages::tableSize> dispatchTable;
 
         const websocket::util::Listener<spy::util::UUID> clientDisconnectListener;
 };
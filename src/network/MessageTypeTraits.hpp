@@ -2,12 +2,14 @@
  * @file   MessageTypeTraits.hpp
  * @author Dominik Authaler
  * @date   09.05.2020 (creation)
- * @brief  Declaration of helper type traits to filter messages.
+ * @brief  List of the inbound message types with the roles allowed to send them.
  */
 
 #ifndef SERVER017_MESSAGE_TYPE_TRAITS_HPP
 #define SERVER017_MESSAGE_TYPE_TRAITS_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <network/messages/Hello.hpp>
 #include <network/messages/Reconnect.hpp>
 #include <network/messages/ItemChoice.hpp>
@@ -18,124 +20,70 @@
 #include <network/messages/RequestMetaInformation.hpp>
 #include <network/messages/RequestReplay.hpp>
 
-template <typename T>
-struct receivableFromPlayer {
-    static constexpr bool value = false;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::Hello> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::Reconnect> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::ItemChoice> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::EquipmentChoice> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::GameOperation> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::GameLeave> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::RequestGamePause> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::RequestMetaInformation> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromPlayer<spy::network::messages::RequestReplay> {
-    static constexpr bool value = true;
-};
-
-template <typename T>
-struct receivableFromAI {
-    static constexpr bool value = false;
-};
-
-template <>
-struct receivableFromAI<spy::network::messages::Hello> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromAI<spy::network::messages::Reconnect> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromAI<spy::network::messages::ItemChoice> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromAI<spy::network::messages::EquipmentChoice> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromAI<spy::network::messages::GameOperation> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromAI<spy::network::messages::RequestMetaInformation> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromAI<spy::network::messages::RequestReplay> {
-    static constexpr bool value = true;
-};
-
-template <typename T>
-struct receivableFromSpectator {
-    static constexpr bool value = false;
-};
-
-template <>
-struct receivableFromSpectator<spy::network::messages::Hello> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromSpectator<spy::network::messages::Reconnect> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromSpectator<spy::network::messages::GameLeave> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromSpectator<spy::network::messages::RequestMetaInformation> {
-    static constexpr bool value = true;
-};
-
-template <>
-struct receivableFromSpectator<spy::network::messages::RequestReplay> {
-    static constexpr bool value = true;
-};
+namespace inbound {
+    using RoleMask = uint8_t;
+
+    constexpr RoleMask player = 1u << 0u;
+    constexpr RoleMask ai = 1u << 1u;
+    constexpr RoleMask spectator = 1u << 2u;
+    constexpr RoleMask anyRole = player | ai | spectator;
+
+    /**
+     * Clients without known role, e.g. before their Hello has been answered.
+     */
+    constexpr RoleMask unassigned = 1u << 3u;
+
+    constexpr RoleMask maskOf(spy::network::RoleEnum role) {
+        switch (role) {
+            case spy::network::RoleEnum::PLAYER:
+                return player;
+            case spy::network::RoleEnum::AI:
+                return ai;
+            case spy::network::RoleEnum::SPECTATOR:
+                return spectator;
+            default:
+                return 0;
+        }
+    }
+
+    /**
+     * A message type the server accepts from clients.
+     * @tparam Message      Type the message is decoded to
+     * @tparam messageType  Value of the type field of the message
+     * @tparam allowedRoles Roles allowed to send the message
+     */
+    template<typename Message, spy::network::messages::MessageTypeEnum messageType, RoleMask allowedRoles>
+    struct MessageEntry {
+        using type = Message;
+        static constexpr spy::network::messages::MessageTypeEnum typeEnum = messageType;
+        static constexpr RoleMask roles = allowedRoles;
+    };
+
+    template<typename ...Entries>
+    struct MessageList {
+        /**
+         * Size of a table indexed by the type of any message in the list.
+         */
+        static constexpr std::size_t tableSize = std::max({static_cast<std::size_t>(Entries::typeEnum)...}) + 1;
+    };
+
+    using spy::network::messages::MessageTypeEnum;
+
+    /**
+     * All inbound messages. MessageRouter generates its dispatch table and listeners from this list, so a new
+     * message type only needs an entry here.
+     */
+    using Messages = MessageList<
+            MessageEntry<spy::network::messages::Hello, MessageTypeEnum::HELLO, anyRole | unassigned>,
+            MessageEntry<spy::network::messages::Reconnect, MessageTypeEnum::RECONNECT, anyRole | unassigned>,
+            MessageEntry<spy::network::messages::ItemChoice, MessageTypeEnum::ITEM_CHOICE, player | ai>,
+            MessageEntry<spy::network::messages::EquipmentChoice, MessageTypeEnum::EQUIPMENT_CHOICE, player | ai>,
+            MessageEntry<spy::network::messages::GameOperation, MessageTypeEnum::GAME_OPERATION, player | ai>,
+            MessageEntry<spy::network::messages::GameLeave, MessageTypeEnum::GAME_LEAVE, player | spectator>,
+            MessageEntry<spy::network::messages::RequestGamePause, MessageTypeEnum::REQUEST_GAME_PAUSE, player>,
+            MessageEntry<spy::network::messages::RequestMetaInformation, MessageTypeEnum::REQUEST_META_INFORMATION,
+                    anyRole>,
+            MessageEntry<spy::network::messages::RequestReplay, MessageTypeEnum::REQUEST_REPLAY, anyRole>>;
+}
 
 #endif //SERVER017_MESSAGE_TYPE_TRAITS_HPP
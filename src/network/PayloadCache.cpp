@@ -0,0 +1,130 @@
+/**
+ * @file   PayloadCache.cpp
+ * @brief  Implementation of the payload cache.
+ */
+
+#include "PayloadCache.hpp"
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include <network/MessageContainer.hpp>
+#include <network/messages/HelloReply.hpp>
+
+namespace {
+    /**
+     * Serializes the fields of an object that are not part of another object.
+     */
+    std::string fieldsNotIn(const nlohmann::json &object, const nlohmann::json &excluded) {
+        std::string fields;
+        for (const auto &field : object.items()) {
+            if (excluded.contains(field.key())) {
+                continue;
+            }
+            if (not fields.empty()) {
+                fields += ',';
+            }
+            fields += nlohmann::json(field.key()).dump();
+            fields += ':';
+            fields += field.value().dump();
+        }
+        return fields;
+    }
+}
+
+PayloadCache::PayloadCache(const spy::scenario::Scenario &scenario,
+                           const spy::MatchConfig &matchConfig,
+                           const std::vector<spy::character::CharacterInformation> &characterInformations) {
+    using spy::network::messages::MessageTypeEnum;
+    using spy::network::messages::MetaInformation;
+
+    // Everything except the container fields and the session id is the same for all clients
+    nlohmann::json helloReplyContainer = spy::network::MessageContainer{MessageTypeEnum::HELLO_REPLY, {}};
+    helloReplyContainer["sessionId"] = spy::util::UUID{};
+    helloReplyBody = fieldsNotIn(spy::network::messages::HelloReply{{}, {}, scenario, matchConfig,
+                                                                     characterInformations},
+                                 helloReplyContainer);
+
+    nlohmann::json metaContainer = spy::network::MessageContainer{MessageTypeEnum::META_INFORMATION, {}};
+    nlohmann::json metaMessage = MetaInformation{{}, {}};
+    for (const auto &field : metaMessage.items()) {
+        if (not metaContainer.contains(field.key())) {
+            informationKey = field.key();
+        }
+    }
+
+    std::array<std::string, configurationKeys.size()> entries;
+    for (std::size_t i = 0; i < configurationKeys.size(); i++) {
+        MetaInformation::Info info;
+        switch (configurationKeys.at(i)) {
+            case MetaInformationKey::CONFIGURATION_SCENARIO:
+                info = scenario;
+                break;
+            case MetaInformationKey::CONFIGURATION_MATCH_CONFIG:
+                info = matchConfig;
+                break;
+            default:
+                info = characterInformations;
+                break;
+        }
+        nlohmann::json message = MetaInformation{{}, {{configurationKeys.at(i), info}}};
+        entries.at(i) = fieldsNotIn(message.at(informationKey), nlohmann::json::object());
+    }
+
+    for (std::size_t mask = 0; mask < configurationEntries.size(); mask++) {
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            if ((mask & (1u << i)) == 0) {
+                continue;
+            }
+            if (not configurationEntries.at(mask).empty()) {
+                configurationEntries.at(mask) += ',';
+            }
+            configurationEntries.at(mask) += entries.at(i);
+        }
+    }
+}
+
+bool PayloadCache::isConfigurationKey(MetaInformationKey key) {
+    return std::find(configurationKeys.begin(), configurationKeys.end(), key) != configurationKeys.end();
+}
+
+std::string PayloadCache::helloReply(const spy::util::UUID &clientId, const spy::util::UUID &sessionId) const {
+    nlohmann::json container = spy::network::MessageContainer{
+            spy::network::messages::MessageTypeEnum::HELLO_REPLY, clientId};
+    container["sessionId"] = sessionId;
+    return splice(container.dump(), helloReplyBody);
+}
+
+std::string PayloadCache::metaInformation(
+        const spy::util::UUID &clientId,
+        const std::vector<MetaInformationKey> &keys,
+        const std::map<MetaInformationKey, spy::network::messages::MetaInformation::Info> &information) const {
+    std::size_t mask = 0;
+    for (const auto key : keys) {
+        auto index = std::find(configurationKeys.begin(), configurationKeys.end(), key) - configurationKeys.begin();
+        mask |= 1u << static_cast<std::size_t>(index);
+    }
+
+    std::string entries = configurationEntries.at(mask);
+    if (not information.empty()) {
+        nlohmann::json message = spy::network::messages::MetaInformation{{}, information};
+        auto computedEntries = fieldsNotIn(message.at(informationKey), nlohmann::json::object());
+        if (not entries.empty()) {
+            entries += ',';
+        }
+        entries += computedEntries;
+    }
+
+    nlohmann::json container = spy::network::MessageContainer{
+            spy::network::messages::MessageTypeEnum::META_INFORMATION, clientId};
+    return splice(container.dump(), nlohmann::json(informationKey).dump() + ":{" + entries + '}');
+}
+
+std::string PayloadCache::splice(std::string container, const std::string &body) {
+    container.pop_back();
+    container.reserve(container.size() + body.size() + 2);
+    if (not body.empty()) {
+        container += ',';
+        container += body;
+    }
+    container += '}';
+    return container;
+}
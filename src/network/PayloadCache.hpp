@@ -0,0 +1,82 @@
+/**
+ * @file   PayloadCache.hpp
+ * @brief  Configuration parts of HelloReply and MetaInformation messages, serialized once.
+ */
+
+#ifndef SERVER017_PAYLOAD_CACHE_HPP
+#define SERVER017_PAYLOAD_CACHE_HPP
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+#include <datatypes/matchconfig/MatchConfig.hpp>
+#include <datatypes/scenario/Scenario.hpp>
+#include <datatypes/character/CharacterInformation.hpp>
+#include <network/messages/MetaInformation.hpp>
+#include <network/messages/MetaInformationKey.hpp>
+#include <util/UUID.hpp>
+
+/**
+ * The scenario, match configuration and character informations don't change after the server loaded them, but
+ * are part of every HelloReply and of MetaInformation replies for the CONFIGURATION_* keys. This cache
+ * serializes them once; outgoing frames are built by serializing only the message container and the per-client
+ * fields and splicing the cached JSON text in.
+ *
+ * The cached fragments are taken from the LibCommon serialization of the messages, so the frames are identical
+ * to serializing the complete message (except for the order of the keys).
+ */
+class PayloadCache {
+    public:
+        using MetaInformationKey = spy::network::messages::MetaInformationKey;
+
+        PayloadCache() = default;
+
+        PayloadCache(const spy::scenario::Scenario &scenario,
+                     const spy::MatchConfig &matchConfig,
+                     const std::vector<spy::character::CharacterInformation> &characterInformations);
+
+        /**
+         * @return True for the keys whose values are part of the cache
+         */
+        static bool isConfigurationKey(MetaInformationKey key);
+
+        /**
+         * @return Serialized HelloReply message
+         */
+        [[nodiscard]] std::string helloReply(const spy::util::UUID &clientId, const spy::util::UUID &sessionId) const;
+
+        /**
+         * Creates a MetaInformation message from cached configuration entries and entries computed per request.
+         * @param configurationKeys Requested keys for which isConfigurationKey is true
+         * @param information       Values of all other requested keys
+         * @return Serialized MetaInformation message
+         */
+        [[nodiscard]] std::string metaInformation(
+                const spy::util::UUID &clientId,
+                const std::vector<MetaInformationKey> &configurationKeys,
+                const std::map<MetaInformationKey, spy::network::messages::MetaInformation::Info> &information) const;
+
+    private:
+        static constexpr std::array<MetaInformationKey, 3> configurationKeys = {
+                MetaInformationKey::CONFIGURATION_SCENARIO,
+                MetaInformationKey::CONFIGURATION_MATCH_CONFIG,
+                MetaInformationKey::CONFIGURATION_CHARACTER_INFORMATION
+        };
+
+        // Fields of the HelloReply that don't depend on the client, separated by commas
+        std::string helloReplyBody;
+
+        // Name of the object containing the entries in a MetaInformation message
+        std::string informationKey = "information";
+
+        // Entries for every subset of the configuration keys, indexed by a bitmask over configurationKeys
+        std::array<std::string, 1u << configurationKeys.size()> configurationEntries;
+
+        /**
+         * Appends serialized fields ("key":value,...) to a serialized JSON object.
+         */
+        static std::string splice(std::string container, const std::string &body);
+};
+
+#endif //SERVER017_PAYLOAD_CACHE_HPP
@@ -0,0 +1,111 @@
+/**
+ * @file   SpectatorRelay.cpp
+ * @brief  Implementation of the spectator relay.
+ */
+
+#include "SpectatorRelay.hpp"
+#include <algorithm>
+#include <functional>
+#include <spdlog/spdlog.h>
+
+SpectatorRelay::SpectatorRelay(unsigned int shardCount) {
+    shardCount = std::max(shardCount, 1u);
+    for (unsigned int i = 0; i < shardCount; i++) {
+        auto &shard = shards.emplace_back(std::make_unique<Shard>());
+        shard->worker = std::thread{work, std::ref(*shard)};
+    }
+}
+
+SpectatorRelay::~SpectatorRelay() {
+    for (auto &shard : shards) {
+        {
+            std::lock_guard<std::mutex> lock{shard->mutex};
+            shard->stopped = true;
+        }
+        shard->wakeUp.notify_one();
+    }
+    for (auto &shard : shards) {
+        shard->worker.join();
+    }
+}
+
+void SpectatorRelay::add(const connectionPtr &connection, const spy::util::UUID &clientId) {
+    enqueue(shardOf(connection), Task{Task::Kind::add, connection, clientId, {}, nullptr});
+}
+
+void SpectatorRelay::remove(const connectionPtr &connection) {
+    enqueue(shardOf(connection), Task{Task::Kind::remove, connection, {}, {}, nullptr});
+}
+
+void SpectatorRelay::send(const connectionPtr &connection, std::string frame) {
+    enqueue(shardOf(connection), Task{Task::Kind::send, connection, {}, std::move(frame), nullptr});
+}
+
+void SpectatorRelay::publish(std::shared_ptr<const AddressableFrame> frame) {
+    for (auto &shard : shards) {
+        enqueue(*shard, Task{Task::Kind::publish, nullptr, {}, {}, frame});
+    }
+}
+
+std::size_t SpectatorRelay::queueDepth() const {
+    std::size_t depth = 0;
+    for (const auto &shard : shards) {
+        depth = std::max(depth, shard->pending.load());
+    }
+    return depth;
+}
+
+SpectatorRelay::Shard &SpectatorRelay::shardOf(const connectionPtr &connection) {
+    return *shards.at(std::hash<connectionPtr>{}(connection) % shards.size());
+}
+
+void SpectatorRelay::enqueue(Shard &shard, Task task) {
+    {
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        shard.pending++;
+        shard.queue.push_back(std::move(task));
+    }
+    shard.wakeUp.notify_one();
+}
+
+void SpectatorRelay::work(Shard &shard) {
+    std::deque<Task> tasks;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{shard.mutex};
+            shard.wakeUp.wait(lock, [&shard]() {
+                return shard.stopped or not shard.queue.empty();
+            });
+            if (shard.queue.empty()) {
+                return;
+            }
+            // Take the whole queue, so the game thread is not blocked while the frames are sent
+            tasks.swap(shard.queue);
+        }
+
+        for (auto &task : tasks) {
+            try {
+                switch (task.kind) {
+                    case Task::Kind::add:
+                        shard.members[task.connection] = task.clientId;
+                        break;
+                    case Task::Kind::remove:
+                        shard.members.erase(task.connection);
+                        break;
+                    case Task::Kind::send:
+                        task.connection->send(task.frame);
+                        break;
+                    case Task::Kind::publish:
+                        for (const auto &[connection, clientId] : shard.members) {
+                            connection->send(task.publishedFrame->addressedTo(clientId));
+                        }
+                        break;
+                }
+            } catch (const std::exception &e) {
+                spdlog::error("Spectator relay failed to send: {}", e.what());
+            }
+            shard.pending--;
+        }
+        tasks.clear();
+    }
+}
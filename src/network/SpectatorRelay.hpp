@@ -0,0 +1,114 @@
+/**
+ * @file   SpectatorRelay.hpp
+ * @brief  Worker threads sending all frames to spectators, off the game thread.
+ */
+
+#ifndef SERVER017_SPECTATOR_RELAY_HPP
+#define SERVER017_SPECTATOR_RELAY_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <util/UUID.hpp>
+#include "AddressableFrame.hpp"
+#include "transport/Transport.hpp"
+
+/**
+ * Owns the send path of the spectator connections. Every connection is assigned to one of several shards, each
+ * shard has its own worker thread and a FIFO queue, so the frames of one connection are sent in the order they
+ * were queued while different connections are served in parallel.
+ *
+ * A state broadcast is published once per shard as a single AddressableFrame, the shard addresses and sends it
+ * to all of its connections. The cost for the game thread is thereby independent of the number of spectators.
+ */
+class SpectatorRelay {
+    public:
+        using connectionPtr = transport::Transport::connectionPtr;
+
+        /**
+         * Starts the worker threads.
+         * @param shards Number of worker threads, at least one is started
+         */
+        explicit SpectatorRelay(unsigned int shards);
+
+        SpectatorRelay(const SpectatorRelay &other) = delete;
+
+        SpectatorRelay &operator=(const SpectatorRelay &other) = delete;
+
+        /**
+         * Stops the worker threads after they sent all queued frames.
+         */
+        ~SpectatorRelay();
+
+        /**
+         * Adds a connection to the receivers of published frames.
+         */
+        void add(const connectionPtr &connection, const spy::util::UUID &clientId);
+
+        /**
+         * Removes a connection, frames queued before are still sent.
+         */
+        void remove(const connectionPtr &connection);
+
+        /**
+         * Queues a frame for a single connection.
+         */
+        void send(const connectionPtr &connection, std::string frame);
+
+        /**
+         * Queues a frame for all connections added before, addressed to their respective client.
+         */
+        void publish(std::shared_ptr<const AddressableFrame> frame);
+
+        /**
+         * @return Number of tasks not yet executed by the shard with the longest queue
+         */
+        [[nodiscard]] std::size_t queueDepth() const;
+
+    private:
+        struct Task {
+            enum class Kind {
+                add,
+                remove,
+                send,
+                publish
+            };
+
+            Kind kind;
+            connectionPtr connection;
+            spy::util::UUID clientId;
+            std::string frame;
+            std::shared_ptr<const AddressableFrame> publishedFrame;
+        };
+
+        struct Shard {
+            mutable std::mutex mutex;
+            std::condition_variable wakeUp;
+            std::deque<Task> queue;
+            bool stopped = false;
+
+            // Queued and not yet executed tasks, including those taken from the queue by the worker
+            std::atomic<std::size_t> pending{0};
+
+            // Only accessed by the worker thread of the shard
+            std::map<connectionPtr, spy::util::UUID> members;
+
+            std::thread worker;
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards;
+
+        Shard &shardOf(const connectionPtr &connection);
+
+        static void enqueue(Shard &shard, Task task);
+
+        static void work(Shard &shard);
+};
+
+#endif //SERVER017_SPECTATOR_RELAY_HPP
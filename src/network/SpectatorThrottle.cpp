@@ -0,0 +1,140 @@
+/**
+ * @file   SpectatorThrottle.cpp
+ * @brief  Implementation of the spectator update policy.
+ */
+
+#include "SpectatorThrottle.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+namespace {
+    const char *policyName(SpectatorThrottle::Policy policy) {
+        switch (policy) {
+            case SpectatorThrottle::Policy::immediate:
+                return "immediate";
+            case SpectatorThrottle::Policy::rate:
+                return "rate";
+            default:
+                return "turn";
+        }
+    }
+}
+
+SpectatorThrottle::SpectatorThrottle(Policy policy, unsigned int updatesPerSecond, std::size_t maxQueueDepth,
+                                     double maxCpuLoad) :
+        configuredPolicy(policy),
+        policy(policy),
+        interval(std::chrono::seconds{1} / std::max(updatesPerSecond, 1u)),
+        maxQueueDepth(maxQueueDepth),
+        maxCpuLoad(maxCpuLoad) {}
+
+SpectatorThrottle SpectatorThrottle::fromOption(const std::string &policy, std::size_t maxQueueDepth,
+                                                double maxCpuLoad) {
+    if (policy == "immediate") {
+        return SpectatorThrottle{Policy::immediate, defaultUpdatesPerSecond, maxQueueDepth, maxCpuLoad};
+    }
+    if (policy == "turn") {
+        return SpectatorThrottle{Policy::endOfTurn, defaultUpdatesPerSecond, maxQueueDepth, maxCpuLoad};
+    }
+
+    const std::string ratePrefix = "rate:";
+    if (policy.rfind(ratePrefix, 0) == 0) {
+        auto updatesPerSecond = std::stoul(policy.substr(ratePrefix.size()));
+        if (updatesPerSecond == 0) {
+            throw std::invalid_argument{"Spectator update rate has to be at least 1"};
+        }
+        return SpectatorThrottle{Policy::rate, static_cast<unsigned int>(updatesPerSecond), maxQueueDepth,
+                                 maxCpuLoad};
+    }
+
+    throw std::invalid_argument{"Unknown spectator policy " + policy};
+}
+
+bool SpectatorThrottle::update(const Operations &operations, bool turnEnded, Clock::time_point now) {
+    withheldOperations.insert(withheldOperations.end(), operations.begin(), operations.end());
+
+    bool send;
+    switch (policy) {
+        case Policy::immediate:
+            send = true;
+            break;
+        case Policy::rate:
+            send = now - lastSent >= interval;
+            break;
+        default:
+            send = turnEnded;
+            break;
+    }
+
+    withheld = not send;
+    if (send) {
+        lastSent = now;
+    }
+    return send;
+}
+
+bool SpectatorThrottle::flush(Clock::time_point now) {
+    if (not withheld or policy != Policy::rate) {
+        return false;
+    }
+    withheld = false;
+    lastSent = now;
+    return true;
+}
+
+SpectatorThrottle::Operations SpectatorThrottle::takeOperations() {
+    Operations operations;
+    operations.swap(withheldOperations);
+    return operations;
+}
+
+void SpectatorThrottle::reportLoad(std::size_t queueDepth) {
+    auto now = steadyClock::now();
+    if (now - windowStart >= loadWindow) {
+        auto cpuNow = std::clock();
+        double cpuSeconds = static_cast<double>(cpuNow - windowCpuStart) / CLOCKS_PER_SEC;
+        cpuLoad = cpuSeconds / std::chrono::duration<double>(now - windowStart).count();
+        windowStart = now;
+        windowCpuStart = cpuNow;
+    }
+
+    bool cpuLimited = maxCpuLoad > 0;
+    bool overloaded = queueDepth > maxQueueDepth or (cpuLimited and cpuLoad > maxCpuLoad);
+    bool relaxed = queueDepth <= maxQueueDepth / 2 and (not cpuLimited or cpuLoad <= maxCpuLoad / 2);
+
+    // Give every policy change one load window to take effect
+    if (now - lastPolicyChange < loadWindow) {
+        return;
+    }
+
+    if (overloaded and policy != Policy::endOfTurn) {
+        spdlog::warn("Spectator load too high (queue depth {}, cpu load {:.2f}), stepping down", queueDepth,
+                     cpuLoad);
+        changePolicy(policy == Policy::immediate ? Policy::rate : Policy::endOfTurn);
+    } else if (relaxed and policy != configuredPolicy and now - lastPolicyChange >= recoveryTime) {
+        changePolicy(policy == Policy::endOfTurn ? Policy::rate : Policy::immediate);
+    }
+}
+
+void SpectatorThrottle::reset() {
+    withheldOperations.clear();
+    withheld = false;
+    lastSent = {};
+    if (policy != configuredPolicy) {
+        changePolicy(configuredPolicy);
+    }
+}
+
+SpectatorThrottle::Policy SpectatorThrottle::currentPolicy() const {
+    return policy;
+}
+
+void SpectatorThrottle::changePolicy(Policy newPolicy) {
+    if (newPolicy < configuredPolicy) {
+        newPolicy = configuredPolicy;
+    }
+    spdlog::info("Spectator update policy changed from {} to {}", policyName(policy), policyName(newPolicy));
+    policy = newPolicy;
+    lastPolicyChange = steadyClock::now();
+}
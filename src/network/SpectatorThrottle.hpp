@@ -0,0 +1,118 @@
+/**
+ * @file   SpectatorThrottle.hpp
+ * @brief  Update policy of the spectators with automatic load shedding.
+ */
+
+#ifndef SERVER017_SPECTATOR_THROTTLE_HPP
+#define SERVER017_SPECTATOR_THROTTLE_HPP
+
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+#include <network/messages/GameOperation.hpp>
+#include "util/Clock.hpp"
+
+/**
+ * Decides which state updates are sent to the spectators. The operations of withheld updates are folded into
+ * the next update that is sent, so spectators still receive every operation.
+ *
+ * Policies, from fine to coarse:
+ * - immediate: every update is sent
+ * - rate:N:    at most N updates per second
+ * - turn:      only the update at the end of a turn
+ *
+ * If the spectator relay queue or the CPU load of the server exceed their thresholds, the throttle steps down to
+ * the next coarser policy. Once the load stayed below half of the thresholds for a while it steps up again, but
+ * never to a finer policy than the configured one.
+ */
+class SpectatorThrottle {
+    public:
+        enum class Policy {
+            immediate,
+            rate,
+            endOfTurn
+        };
+
+        using Operations = std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>>;
+
+        static constexpr unsigned int defaultUpdatesPerSecond = 4;
+        static constexpr std::size_t defaultMaxQueueDepth = 256;
+
+        /**
+         * Creates a throttle sending every update.
+         */
+        SpectatorThrottle() = default;
+
+        /**
+         * @param updatesPerSecond Rate of the rate policy, also used when stepping down from immediate
+         * @param maxQueueDepth    Relay queue depth above which the throttle steps down
+         * @param maxCpuLoad       CPU time of the process per wall time above which the throttle steps down,
+         *                         0 disables the CPU threshold
+         */
+        SpectatorThrottle(Policy policy, unsigned int updatesPerSecond, std::size_t maxQueueDepth, double maxCpuLoad);
+
+        /**
+         * Parses a policy option of the form "immediate", "rate:N" or "turn".
+         * @throws std::invalid_argument if the option is malformed
+         */
+        static SpectatorThrottle fromOption(const std::string &policy, std::size_t maxQueueDepth, double maxCpuLoad);
+
+        /**
+         * Adds the operations of a state update and decides whether the spectators receive the update.
+         * @param turnEnded True if the active character can't make another operation
+         * @return True if the update has to be sent, with the operations returned by takeOperations
+         */
+        bool update(const Operations &operations, bool turnEnded, Clock::time_point now);
+
+        /**
+         * Decides whether a withheld update is sent before the game waits for a player. Only the rate policy
+         * delivers updates while a turn is not finished.
+         * @return True if the update has to be sent, with the operations returned by takeOperations
+         */
+        bool flush(Clock::time_point now);
+
+        /**
+         * @return All operations since the last update that was sent, the throttle forgets them
+         */
+        Operations takeOperations();
+
+        /**
+         * Checks the load of the server and steps the policy down or up.
+         * @param queueDepth Current queue depth of the spectator relay
+         */
+        void reportLoad(std::size_t queueDepth);
+
+        /**
+         * Forgets withheld operations and returns to the configured policy, called at the start of a game.
+         */
+        void reset();
+
+        [[nodiscard]] Policy currentPolicy() const;
+
+    private:
+        using steadyClock = std::chrono::steady_clock;
+
+        static constexpr std::chrono::seconds loadWindow{1};
+        static constexpr std::chrono::seconds recoveryTime{10};
+
+        Policy configuredPolicy = Policy::immediate;
+        Policy policy = Policy::immediate;
+        std::chrono::nanoseconds interval = std::chrono::seconds{1} / defaultUpdatesPerSecond;
+        std::size_t maxQueueDepth = defaultMaxQueueDepth;
+        double maxCpuLoad = 0;
+
+        Operations withheldOperations;
+        bool withheld = false;
+        Clock::time_point lastSent;
+
+        steadyClock::time_point windowStart = steadyClock::now();
+        std::clock_t windowCpuStart = std::clock();
+        double cpuLoad = 0;
+        steadyClock::time_point lastPolicyChange = steadyClock::now();
+
+        void changePolicy(Policy newPolicy);
+};
+
+#endif //SERVER017_SPECTATOR_THROTTLE_HPP
@@ -0,0 +1,134 @@
+/**
+ * @file   TrafficCapture.cpp
+ * @brief  Implementation of the traffic capture.
+ */
+
+#include "TrafficCapture.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+namespace {
+    template<typename T>
+    void putLittleEndian(std::ofstream &out, T value) {
+        std::array<char, sizeof(T)> bytes{};
+        for (auto &b : bytes) {
+            b = static_cast<char>(value & 0xFFu);
+            value = static_cast<T>(value >> 8u);
+        }
+        out.write(bytes.data(), bytes.size());
+    }
+
+    template<typename T>
+    bool getLittleEndian(std::ifstream &in, T &value) {
+        std::array<unsigned char, sizeof(T)> bytes{};
+        if (not in.read(reinterpret_cast<char *>(bytes.data()), bytes.size())) {
+            return false;
+        }
+        value = 0;
+        for (auto b = bytes.rbegin(); b != bytes.rend(); b++) {
+            value = static_cast<T>((value << 8u) | *b);
+        }
+        return true;
+    }
+}
+
+TrafficCapture::TrafficCapture(const std::string &path, unsigned int seed) :
+        file{path, std::ios::binary | std::ios::trunc} {
+    if (not file) {
+        throw std::runtime_error{"Could not open capture file " + path};
+    }
+    file.write(magic, sizeof(magic));
+    write(Kind::seed, 0, std::to_string(seed));
+}
+
+TrafficCapture::~TrafficCapture() {
+    file.flush();
+}
+
+void TrafficCapture::recordConnect(const transport::Transport::connectionPtr &connection) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto id = nextConnectionId++;
+    connectionIds.emplace(connection, id);
+    write(Kind::connect, id, {});
+}
+
+void TrafficCapture::recordMessage(const transport::Transport::connectionPtr &connection,
+                                   const std::string &message) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto id = connectionIds.find(connection);
+    if (id == connectionIds.end()) {
+        spdlog::warn("Capture: message from a connection that connected before the capture started");
+        return;
+    }
+    write(Kind::message, id->second, message);
+}
+
+void TrafficCapture::recordClose(const transport::Transport::connectionPtr &connection) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto id = connectionIds.find(connection);
+    if (id == connectionIds.end()) {
+        return;
+    }
+    write(Kind::close, id->second, {});
+    connectionIds.erase(id);
+
+    // Closes are rare compared to messages, so the file is flushed here instead of after every record
+    file.flush();
+}
+
+void TrafficCapture::recordSent(const transport::Transport::connectionPtr &connection, const std::string &frame) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto id = connectionIds.find(connection);
+    if (id == connectionIds.end()) {
+        return;
+    }
+    write(Kind::sent, id->second, frame);
+}
+
+void TrafficCapture::write(Kind kind, std::uint32_t connection, const std::string &payload) {
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    putLittleEndian(file, static_cast<std::uint8_t>(kind));
+    putLittleEndian(file, connection);
+    putLittleEndian(file, static_cast<std::uint64_t>(time.count()));
+    putLittleEndian(file, static_cast<std::uint32_t>(payload.size()));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+}
+
+std::vector<TrafficCapture::Record> TrafficCapture::read(const std::string &path) {
+    std::ifstream in{path, std::ios::binary};
+    if (not in) {
+        throw std::runtime_error{"Could not open capture file " + path};
+    }
+
+    char header[sizeof(magic)];
+    if (not in.read(header, sizeof(header)) or not std::equal(std::begin(header), std::end(header), magic)) {
+        throw std::runtime_error{path + " is not a capture file"};
+    }
+
+    std::vector<Record> records;
+    while (true) {
+        std::uint8_t kind;
+        std::uint32_t connection;
+        std::uint64_t time;
+        std::uint32_t length;
+        if (not getLittleEndian(in, kind) or not getLittleEndian(in, connection) or not getLittleEndian(in, time)
+            or not getLittleEndian(in, length) or kind > static_cast<std::uint8_t>(Kind::seed)) {
+            break;
+        }
+        // Checked before allocating the payload, a corrupt length must not allocate up to 4 GiB
+        if (length > maxPayloadLength) {
+            throw std::runtime_error{path + " is corrupt: record of " + std::to_string(length) + " bytes"};
+        }
+
+        std::string payload(length, '\0');
+        if (not in.read(payload.data(), length)) {
+            break;
+        }
+        records.push_back(Record{static_cast<Kind>(kind), connection, std::chrono::nanoseconds{time},
+                                 std::move(payload)});
+    }
+    return records;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file   TrafficCapture.hpp
+ * @brief  Compact binary log of the inbound traffic of the server, used to replay it in benchmarks.
+ */
+
+#ifndef SERVER017_TRAFFIC_CAPTURE_HPP
+#define SERVER017_TRAFFIC_CAPTURE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "transport/Transport.hpp"
+
+/**
+ * Records connects, inbound frames and closes of all connections. To replay a match, the seed of the server and
+ * the item offers sent to the players are recorded as well: the replay maps the captured choices to the offers
+ * of the replayed server by their index.
+ *
+ * File format (all integers little endian):
+ *  - header: the 8 bytes of magic
+ *  - records: kind (u8), connection id (u32), nanoseconds since the start of the capture (u64),
+ *             payload length (u32), payload (frame for messages and sent frames, the seed as decimal number for
+ *             the seed record, empty otherwise)
+ *
+ * Connection ids are assigned in order of the connects, starting with 0. The seed record is the first record,
+ * its connection id is 0.
+ */
+class TrafficCapture {
+    public:
+        static constexpr char magic[8] = {'S', '1', '7', 'C', 'A', 'P', '0', '1'};
+
+        enum class Kind : std::uint8_t {
+            connect = 0,
+            message = 1,
+            close = 2,
+            sent = 3,
+            seed = 4
+        };
+
+        /**
+         * Upper bound of the payload length accepted when reading, a larger length means the file is corrupt.
+         */
+        static constexpr std::uint32_t maxPayloadLength = 16u << 20u;
+
+        struct Record {
+            Kind kind;
+            std::uint32_t connection;
+            std::chrono::nanoseconds time;
+            std::string payload;
+        };
+
+        /**
+         * Creates the file, an existing file is overwritten.
+         * @param seed Seed of the random numbers of the server
+         * @throws std::runtime_error if the file can not be opened
+         */
+        TrafficCapture(const std::string &path, unsigned int seed);
+
+        ~TrafficCapture();
+
+        void recordConnect(const transport::Transport::connectionPtr &connection);
+
+        void recordMessage(const transport::Transport::connectionPtr &connection, const std::string &message);
+
+        void recordClose(const transport::Transport::connectionPtr &connection);
+
+        /**
+         * Records a frame sent to the connection.
+         */
+        void recordSent(const transport::Transport::connectionPtr &connection, const std::string &frame);
+
+        /**
+         * Reads all records of a capture. A truncated last record (server killed while writing) is ignored.
+         * @throws std::runtime_error if the file can not be opened, is no capture or contains a record longer than
+         *                            maxPayloadLength
+         */
+        static std::vector<Record> read(const std::string &path);
+
+    private:
+        std::mutex mutex;
+        std::ofstream file;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::map<transport::Transport::connectionPtr, std::uint32_t> connectionIds;
+        std::uint32_t nextConnectionId = 0;
+
+        void write(Kind kind, std::uint32_t connection, const std::string &payload);
+};
+
+#endif //SERVER017_TRAFFIC_CAPTURE_HPP
@@ -0,0 +1,624 @@
+/**
+ * @file   EpollTransport.cpp
+ * @brief  Implementation of the epoll transport.
+ */
+
+#include "EpollTransport.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <spdlog/spdlog.h>
+#include "Rfc6455.hpp"
+
+namespace transport {
+    namespace {
+        constexpr std::size_t readChunkSize = 64 * 1024;
+        constexpr std::size_t maxHandshakeSize = 8 * 1024;
+        constexpr std::size_t maxIovecs = 64;
+        constexpr int maxEvents = 256;
+
+        // Set in the event loop thread, lets scheduleFlush skip the wakeup if called by the loop itself
+        thread_local const EpollTransport *servingTransport = nullptr;
+
+        std::runtime_error systemError(const std::string &what) {
+            return std::runtime_error{what + ": " + std::strerror(errno)};
+        }
+
+        int openTcpSocket(uint16_t port) {
+            int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                throw systemError("Could not create socket");
+            }
+            int reuse = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_ANY);
+            address.sin_port = htons(port);
+            if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 or
+                ::listen(fd, SOMAXCONN) < 0) {
+                auto error = systemError("Could not listen on port " + std::to_string(port));
+                ::close(fd);
+                throw error;
+            }
+            return fd;
+        }
+
+        int openUnixSocket(const std::string &path) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (path.empty() or path.size() >= sizeof(address.sun_path)) {
+                throw std::runtime_error{"Invalid unix socket path " + path};
+            }
+            path.copy(address.sun_path, path.size());
+
+            int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                throw systemError("Could not create unix socket");
+            }
+            // A socket file left behind by a previous server would make bind fail
+            ::unlink(path.c_str());
+            if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 or
+                ::listen(fd, SOMAXCONN) < 0) {
+                auto error = systemError("Could not listen on unix socket " + path);
+                ::close(fd);
+                throw error;
+            }
+            return fd;
+        }
+    }
+
+    EpollTransport::Endpoint EpollTransport::Endpoint::webSocket(uint16_t port) {
+        return Endpoint{Kind::webSocket, port, {}};
+    }
+
+    EpollTransport::Endpoint EpollTransport::Endpoint::unixSocket(std::string path) {
+        return Endpoint{Kind::unixSocket, 0, std::move(path)};
+    }
+
+    unsigned long EpollTransport::Statistics::syscalls() const {
+        return epollWaits + epollControls + accepts + reads + writes + wakeups;
+    }
+
+    EpollTransport::EpollConnection::EpollConnection(EpollTransport &transport, int fd, Endpoint::Kind kind) :
+            transport{transport},
+            fd{fd},
+            kind{kind} {}
+
+    void EpollTransport::EpollConnection::send(const std::string &message) {
+        if (kind == Endpoint::Kind::unixSocket) {
+            std::string frame;
+            frame.reserve(message.size() + 4);
+            for (unsigned int shift = 0; shift < 32; shift += 8) {
+                frame += static_cast<char>((message.size() >> shift) & 0xFFu);
+            }
+            frame += message;
+            enqueue(std::move(frame));
+        } else {
+            enqueue(rfc6455::encodeFrame(rfc6455::Opcode::text, message));
+        }
+        transport.counters.framesOut++;
+    }
+
+    void EpollTransport::EpollConnection::enqueue(std::string bytes) {
+        {
+            std::lock_guard<std::mutex> lock{outputMutex};
+            if (closed) {
+                return;
+            }
+            output.push_back(std::move(bytes));
+            if (flushScheduled) {
+                return;
+            }
+            flushScheduled = true;
+        }
+        transport.scheduleFlush(shared_from_this());
+    }
+
+    EpollTransport::EpollTransport(std::vector<Endpoint> endpoints, std::string protocol, Options options) :
+            protocol{std::move(protocol)},
+            options{options},
+            readBuffer(readChunkSize) {
+        try {
+            epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+            wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (epollFd < 0 or wakeFd < 0) {
+                throw systemError("Could not create event loop");
+            }
+
+            std::vector<int> fds = {wakeFd};
+            for (auto &endpoint : endpoints) {
+                int fd = endpoint.kind == Endpoint::Kind::webSocket ? openTcpSocket(endpoint.port)
+                                                                    : openUnixSocket(endpoint.path);
+                listeners.emplace_back(fd, std::move(endpoint));
+                fds.push_back(fd);
+            }
+            for (int fd : fds) {
+                epoll_event event{};
+                event.events = EPOLLIN | EPOLLET;
+                event.data.fd = fd;
+                if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+                    throw systemError("Could not register socket");
+                }
+            }
+        } catch (const std::runtime_error &) {
+            closeSockets();
+            throw;
+        }
+
+        loopThread = std::thread{&EpollTransport::run, this};
+    }
+
+    EpollTransport::EpollTransport(uint16_t port, std::string protocol, Options options) :
+            EpollTransport{{Endpoint::webSocket(port)}, std::move(protocol), options} {}
+
+    EpollTransport::~EpollTransport() {
+        stopped = true;
+        uint64_t one = 1;
+        if (::write(wakeFd, &one, sizeof(one)) < 0) {
+            spdlog::error("Could not wake the event loop: {}", std::strerror(errno));
+        }
+        loopThread.join();
+
+        for (auto &[fd, connection] : connections) {
+            std::lock_guard<std::mutex> lock{connection->outputMutex};
+            connection->closed = true;
+            ::close(fd);
+        }
+        connections.clear();
+        closeSockets();
+    }
+
+    std::string EpollTransport::description() const {
+        std::string description = "epoll";
+        for (const auto &[fd, endpoint] : listeners) {
+            description += endpoint.kind == Endpoint::Kind::webSocket ? " websocket on port " +
+                                                                        std::to_string(endpoint.port)
+                                                                      : " unix socket " + endpoint.path;
+            description += ',';
+        }
+        description.pop_back();
+        return description;
+    }
+
+    EpollTransport::Statistics EpollTransport::statistics() const {
+        Statistics statistics;
+        statistics.openConnections = counters.openConnections;
+        statistics.acceptedConnections = counters.acceptedConnections;
+        statistics.messagesIn = counters.messagesIn;
+        statistics.framesOut = counters.framesOut;
+        statistics.epollWaits = counters.epollWaits;
+        statistics.epollControls = counters.epollControls;
+        statistics.accepts = counters.accepts;
+        statistics.reads = counters.reads;
+        statistics.writes = counters.writes;
+        statistics.wakeups = counters.wakeups;
+        return statistics;
+    }
+
+    void EpollTransport::run() {
+        servingTransport = this;
+        std::array<epoll_event, maxEvents> events{};
+
+        int timeout = -1;
+        if (options.statisticsInterval.count() > 0) {
+            timeout = static_cast<int>(std::chrono::milliseconds{options.statisticsInterval}.count());
+        }
+        auto lastLog = std::chrono::steady_clock::now();
+
+        while (not stopped) {
+            counters.epollWaits++;
+            int count = ::epoll_wait(epollFd, events.data(), maxEvents, timeout);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                spdlog::critical("Event loop failed: {}", std::strerror(errno));
+                return;
+            }
+
+            for (int i = 0; i < count; i++) {
+                const auto &event = events.at(static_cast<std::size_t>(i));
+                auto listener = std::find_if(listeners.begin(), listeners.end(), [&event](const auto &entry) {
+                    return entry.first == event.data.fd;
+                });
+                if (listener != listeners.end()) {
+                    acceptConnections(listener->first, listener->second);
+                } else if (event.data.fd == wakeFd) {
+                    uint64_t wakeups;
+                    counters.reads++;
+                    if (::read(wakeFd, &wakeups, sizeof(wakeups)) < 0 and errno != EAGAIN) {
+                        spdlog::error("Could not reset the wakeup event: {}", std::strerror(errno));
+                    }
+                } else {
+                    auto it = connections.find(event.data.fd);
+                    if (it == connections.end()) {
+                        continue;
+                    }
+                    auto connection = it->second;
+                    if ((event.events & EPOLLOUT) != 0 and flush(*connection) == FlushResult::failed) {
+                        close(connection);
+                        continue;
+                    }
+                    if ((event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) {
+                        read(connection, (event.events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0);
+                    }
+                }
+            }
+
+            // Everything sent while handling the events above is written with one syscall per connection
+            flushQueued();
+
+            if (options.statisticsInterval.count() > 0 and
+                std::chrono::steady_clock::now() - lastLog >= options.statisticsInterval) {
+                logStatistics();
+                lastLog = std::chrono::steady_clock::now();
+            }
+        }
+    }
+
+    void EpollTransport::acceptConnections(int listenFd, const Endpoint &endpoint) {
+        while (true) {
+            counters.accepts++;
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR or errno == ECONNABORTED) {
+                    continue;
+                }
+                if (errno != EAGAIN and errno != EWOULDBLOCK) {
+                    spdlog::error("Could not accept connection: {}", std::strerror(errno));
+                }
+                return;
+            }
+
+            configureSocket(fd, endpoint);
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            event.data.fd = fd;
+            counters.epollControls++;
+            if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+                spdlog::error("Could not register connection: {}", std::strerror(errno));
+                ::close(fd);
+                continue;
+            }
+            auto connection = std::make_shared<EpollConnection>(*this, fd, endpoint.kind);
+            connections.emplace(fd, connection);
+            counters.acceptedConnections++;
+
+            // Local clients don't have a handshake
+            if (endpoint.kind == Endpoint::Kind::unixSocket) {
+                connection->phase = EpollConnection::Phase::open;
+                counters.openConnections++;
+                connectionListener(connection);
+            }
+        }
+    }
+
+    void EpollTransport::configureSocket(int fd, const Endpoint &endpoint) const {
+        if (options.tcpNoDelay and endpoint.kind == Endpoint::Kind::webSocket) {
+            int noDelay = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+        if (options.sendBufferSize > 0) {
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &options.sendBufferSize, sizeof(options.sendBufferSize));
+        }
+        if (options.receiveBufferSize > 0) {
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &options.receiveBufferSize, sizeof(options.receiveBufferSize));
+        }
+    }
+
+    void EpollTransport::read(const std::shared_ptr<EpollConnection> &connection, bool hangup) {
+        bool peerClosed = false;
+        while (true) {
+            counters.reads++;
+            auto received = ::recv(connection->fd, readBuffer.data(), readBuffer.size(), 0);
+            if (received > 0) {
+                connection->input.append(readBuffer.data(), static_cast<std::size_t>(received));
+                // A short read drained the socket, new data raises a new edge. Only a hangup has to be read
+                // until the end to notice it.
+                if (static_cast<std::size_t>(received) < readBuffer.size() and not hangup) {
+                    break;
+                }
+                continue;
+            }
+            if (received == 0) {
+                peerClosed = true;
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN and errno != EWOULDBLOCK) {
+                peerClosed = true;
+            }
+            break;
+        }
+
+        if (connection->phase == EpollConnection::Phase::handshake) {
+            handleHandshake(connection);
+        }
+        if (connection->phase == EpollConnection::Phase::open) {
+            if (connection->kind == Endpoint::Kind::unixSocket) {
+                handleLengthPrefixedFrames(connection);
+            } else {
+                handleFrames(connection);
+            }
+        }
+        if (peerClosed) {
+            close(connection);
+        }
+    }
+
+    void EpollTransport::handleHandshake(const std::shared_ptr<EpollConnection> &connection) {
+        auto end = connection->input.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            if (connection->input.size() > maxHandshakeSize) {
+                spdlog::warn("Handshake request too large, closing connection");
+                closeWith(connection, rfc6455::handshakeRejection());
+            }
+            return;
+        }
+
+        auto request = rfc6455::parseHandshake(std::string_view{connection->input}.substr(0, end + 4));
+        if (not request.has_value()) {
+            spdlog::warn("Invalid handshake request, closing connection");
+            closeWith(connection, rfc6455::handshakeRejection());
+            return;
+        }
+
+        connection->input.erase(0, end + 4);
+        connection->enqueue(rfc6455::handshakeResponse(request.value(), protocol));
+        connection->phase = EpollConnection::Phase::open;
+        counters.openConnections++;
+        connectionListener(connection);
+    }
+
+    void EpollTransport::handleFrames(const std::shared_ptr<EpollConnection> &connection) {
+        using rfc6455::Opcode;
+        using rfc6455::ParseResult;
+
+        std::size_t offset = 0;
+        rfc6455::Frame frame;
+        while (connection->phase == EpollConnection::Phase::open) {
+            auto result = rfc6455::parseFrame(connection->input, offset, frame, options.maxMessageSize);
+            if (result == ParseResult::incomplete) {
+                break;
+            }
+            if (result == ParseResult::tooLarge) {
+                closeWith(connection, rfc6455::encodeClose(rfc6455::CloseCode::messageTooBig));
+                return;
+            }
+            if (result == ParseResult::protocolError) {
+                // the frame is not filled in, its opcode must not be evaluated
+                spdlog::warn("WebSocket protocol error, closing connection");
+                closeWith(connection, rfc6455::encodeClose(rfc6455::CloseCode::protocolError));
+                return;
+            }
+
+            bool protocolError = false;
+            std::optional<std::string> message;
+            switch (frame.opcode) {
+                case Opcode::text:
+                case Opcode::binary:
+                    if (connection->fragmented) {
+                        protocolError = true;
+                    } else if (frame.fin) {
+                        message = std::move(frame.payload);
+                    } else {
+                        connection->fragmented = true;
+                        connection->fragmentedMessage = std::move(frame.payload);
+                    }
+                    break;
+                case Opcode::continuation:
+                    if (not connection->fragmented) {
+                        protocolError = true;
+                        break;
+                    }
+                    if (connection->fragmentedMessage.size() + frame.payload.size() > options.maxMessageSize) {
+                        closeWith(connection, rfc6455::encodeClose(rfc6455::CloseCode::messageTooBig));
+                        return;
+                    }
+                    connection->fragmentedMessage += frame.payload;
+                    if (frame.fin) {
+                        connection->fragmented = false;
+                        message = std::move(connection->fragmentedMessage);
+                        connection->fragmentedMessage.clear();
+                    }
+                    break;
+                case Opcode::ping:
+                    connection->enqueue(rfc6455::encodeFrame(Opcode::pong, frame.payload));
+                    break;
+                case Opcode::pong:
+                    break;
+                case Opcode::close:
+                    closeWith(connection, rfc6455::encodeClose(rfc6455::CloseCode::normal));
+                    return;
+            }
+
+            if (protocolError) {
+                spdlog::warn("WebSocket protocol error, closing connection");
+                closeWith(connection, rfc6455::encodeClose(rfc6455::CloseCode::protocolError));
+                return;
+            }
+            if (message.has_value()) {
+                counters.messagesIn++;
+                connection->receiveListener(message.value());
+            }
+        }
+
+        if (connection->phase == EpollConnection::Phase::open) {
+            connection->input.erase(0, offset);
+        }
+    }
+
+    void EpollTransport::handleLengthPrefixedFrames(const std::shared_ptr<EpollConnection> &connection) {
+        const std::string &input = connection->input;
+        std::size_t offset = 0;
+        while (connection->phase == EpollConnection::Phase::open and input.size() - offset >= 4) {
+            std::size_t length = 0;
+            for (std::size_t i = 0; i < 4; i++) {
+                length |= static_cast<std::size_t>(static_cast<uint8_t>(input[offset + i])) << (8 * i);
+            }
+            if (length > options.maxMessageSize) {
+                spdlog::warn("Message of {} bytes on unix socket too large, closing connection", length);
+                close(connection);
+                return;
+            }
+            if (input.size() - offset - 4 < length) {
+                break;
+            }
+            counters.messagesIn++;
+            connection->receiveListener(input.substr(offset + 4, length));
+            offset += 4 + length;
+        }
+
+        if (connection->phase == EpollConnection::Phase::open) {
+            connection->input.erase(0, offset);
+        }
+    }
+
+    EpollTransport::FlushResult EpollTransport::flush(EpollConnection &connection) {
+        std::lock_guard<std::mutex> lock{connection.outputMutex};
+        while (not connection.output.empty()) {
+            std::array<iovec, maxIovecs> buffers{};
+            std::size_t bufferCount = 0;
+            for (auto it = connection.output.begin();
+                 it != connection.output.end() and bufferCount < buffers.size(); ++it, ++bufferCount) {
+                std::size_t skip = bufferCount == 0 ? connection.outputOffset : 0;
+                buffers.at(bufferCount).iov_base = it->data() + skip;
+                buffers.at(bufferCount).iov_len = it->size() - skip;
+            }
+
+            msghdr message{};
+            message.msg_iov = buffers.data();
+            message.msg_iovlen = bufferCount;
+            counters.writes++;
+            auto written = ::sendmsg(connection.fd, &message, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN or errno == EWOULDBLOCK) {
+                    // The next EPOLLOUT edge continues, until then sends don't need to schedule a flush
+                    return FlushResult::blocked;
+                }
+                spdlog::warn("Could not send to connection: {}", std::strerror(errno));
+                return FlushResult::failed;
+            }
+
+            auto remaining = static_cast<std::size_t>(written);
+            while (remaining > 0) {
+                std::size_t left = connection.output.front().size() - connection.outputOffset;
+                if (remaining < left) {
+                    connection.outputOffset += remaining;
+                    break;
+                }
+                remaining -= left;
+                connection.output.pop_front();
+                connection.outputOffset = 0;
+            }
+        }
+        connection.flushScheduled = false;
+        return FlushResult::done;
+    }
+
+    void EpollTransport::flushQueued() {
+        std::vector<std::weak_ptr<EpollConnection>> queued;
+        {
+            std::lock_guard<std::mutex> lock{flushMutex};
+            queued.swap(flushQueue);
+        }
+        for (const auto &weakConnection : queued) {
+            auto connection = weakConnection.lock();
+            if (connection == nullptr or connection->phase == EpollConnection::Phase::closed) {
+                continue;
+            }
+            if (flush(*connection) == FlushResult::failed) {
+                close(connection);
+            }
+        }
+    }
+
+    void EpollTransport::scheduleFlush(const std::shared_ptr<EpollConnection> &connection) {
+        {
+            std::lock_guard<std::mutex> lock{flushMutex};
+            flushQueue.push_back(connection);
+        }
+        if (servingTransport != this) {
+            uint64_t one = 1;
+            counters.wakeups++;
+            if (::write(wakeFd, &one, sizeof(one)) < 0) {
+                spdlog::error("Could not wake the event loop: {}", std::strerror(errno));
+            }
+        }
+    }
+
+    void EpollTransport::closeWith(const std::shared_ptr<EpollConnection> &connection, std::string lastBytes) {
+        connection->enqueue(std::move(lastBytes));
+        flush(*connection);
+        close(connection);
+    }
+
+    void EpollTransport::close(std::shared_ptr<EpollConnection> connection) {
+        if (connection->phase == EpollConnection::Phase::closed) {
+            return;
+        }
+        bool wasOpen = connection->phase == EpollConnection::Phase::open;
+        connection->phase = EpollConnection::Phase::closed;
+        {
+            std::lock_guard<std::mutex> lock{connection->outputMutex};
+            connection->closed = true;
+            connection->output.clear();
+        }
+
+        counters.epollControls++;
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+        ::close(connection->fd);
+        connections.erase(connection->fd);
+
+        if (wasOpen) {
+            counters.openConnections--;
+            closeListener(connection);
+        }
+    }
+
+    void EpollTransport::closeSockets() {
+        for (const auto &[fd, endpoint] : listeners) {
+            ::close(fd);
+            if (endpoint.kind == Endpoint::Kind::unixSocket) {
+                ::unlink(endpoint.path.c_str());
+            }
+        }
+        listeners.clear();
+        for (int *fd : {&epollFd, &wakeFd}) {
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+
+    void EpollTransport::logStatistics() const {
+        auto current = statistics();
+        double perMessage = current.messagesIn == 0 ? 0.0 :
+                            static_cast<double>(current.syscalls()) / static_cast<double>(current.messagesIn);
+        spdlog::info("Transport: {} open connections ({} accepted), {} messages in, {} frames out, {} syscalls "
+                     "({:.2f} per inbound message; {} epoll_wait, {} recv/read, {} sendmsg, {} wakeups)",
+                     current.openConnections, current.acceptedConnections, current.messagesIn, current.framesOut,
+                     current.syscalls(), perMessage, current.epollWaits, current.reads, current.writes,
+                     current.wakeups);
+    }
+}
@@ -0,0 +1,222 @@
+/**
+ * @file   EpollTransport.hpp
+ * @brief  WebSocket transport on an edge-triggered epoll event loop.
+ */
+
+#ifndef SERVER017_EPOLLTRANSPORT_HPP
+#define SERVER017_EPOLLTRANSPORT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Transport.hpp"
+
+namespace transport {
+    /**
+     * Accepts WebSocket clients (RFC 6455) on non-blocking TCP sockets, without the WebsocketCPP server, and local
+     * clients on unix domain sockets.
+     *
+     * All sockets are served by a single event loop thread using edge-triggered epoll; the listeners of the
+     * transport and its connections are called from this thread only. Frames sent from any thread are queued
+     * per connection and written by the event loop once per iteration with a single sendmsg per connection, so
+     * the replies to one inbound message are batched. Other threads wake the loop via an eventfd.
+     */
+    class EpollTransport : public Transport {
+        public:
+            struct Options {
+                bool tcpNoDelay = true;
+                int sendBufferSize = 0;     //!< SO_SNDBUF in bytes, 0 keeps the system default
+                int receiveBufferSize = 0;  //!< SO_RCVBUF in bytes, 0 keeps the system default
+                std::size_t maxMessageSize = 1u << 20u;
+                std::chrono::seconds statisticsInterval{0}; //!< Interval of the statistics log, 0 disables it
+            };
+
+            /**
+             * A listening socket. Clients of a unix socket skip the WebSocket handshake and send length-prefixed
+             * frames: the length of the message as 4 byte little-endian integer, followed by the message.
+             */
+            struct Endpoint {
+                enum class Kind {
+                    webSocket,
+                    unixSocket
+                };
+
+                Kind kind;
+                uint16_t port = 0;  //!< TCP port of a webSocket endpoint
+                std::string path;   //!< File system path of a unixSocket endpoint
+
+                static Endpoint webSocket(uint16_t port);
+
+                static Endpoint unixSocket(std::string path);
+            };
+
+            /**
+             * Counters of the event loop, syscalls are counted individually to compare backends.
+             */
+            struct Statistics {
+                unsigned long openConnections = 0;
+                unsigned long acceptedConnections = 0;
+                unsigned long messagesIn = 0;
+                unsigned long framesOut = 0;
+                unsigned long epollWaits = 0;
+                unsigned long epollControls = 0;
+                unsigned long accepts = 0;
+                unsigned long reads = 0;
+                unsigned long writes = 0;
+                unsigned long wakeups = 0;
+
+                [[nodiscard]] unsigned long syscalls() const;
+            };
+
+            /**
+             * Opens the listening sockets and starts the event loop serving all of them.
+             * @param protocol WebSocket subprotocol confirmed to clients offering it
+             * @throws std::runtime_error if a socket can not be opened
+             */
+            EpollTransport(std::vector<Endpoint> endpoints, std::string protocol, Options options);
+
+            /**
+             * Opens a single WebSocket endpoint on the given port.
+             */
+            EpollTransport(uint16_t port, std::string protocol, Options options);
+
+            EpollTransport(const EpollTransport &other) = delete;
+
+            EpollTransport &operator=(const EpollTransport &other) = delete;
+
+            /**
+             * Stops the event loop and closes all sockets without calling the close listener. Unix socket files
+             * are removed.
+             */
+            ~EpollTransport() override;
+
+            [[nodiscard]] std::string description() const override;
+
+            [[nodiscard]] Statistics statistics() const;
+
+        private:
+            class EpollConnection : public Connection, public std::enable_shared_from_this<EpollConnection> {
+                public:
+                    EpollConnection(EpollTransport &transport, int fd, Endpoint::Kind kind);
+
+                    void send(const std::string &message) override;
+
+                private:
+                    friend class EpollTransport;
+
+                    enum class Phase {
+                        handshake,
+                        open,
+                        closed
+                    };
+
+                    EpollTransport &transport;
+                    const int fd;
+                    const Endpoint::Kind kind;
+
+                    // Only accessed by the event loop
+                    Phase phase = Phase::handshake;
+                    std::string input;
+                    std::string fragmentedMessage;
+                    bool fragmented = false;
+
+                    // Guards the fields below, frames are queued from any thread
+                    std::mutex outputMutex;
+                    std::deque<std::string> output;
+                    std::size_t outputOffset = 0; //!< Bytes of the first queued frame already written
+                    bool flushScheduled = false;
+                    bool closed = false;
+
+                    /**
+                     * Queues bytes for writing and schedules a flush by the event loop.
+                     */
+                    void enqueue(std::string bytes);
+            };
+
+            enum class FlushResult {
+                done,
+                blocked,
+                failed
+            };
+
+            std::string protocol;
+            Options options;
+
+            std::vector<std::pair<int, Endpoint>> listeners; //!< Listening sockets and their endpoints
+            int epollFd = -1;
+            int wakeFd = -1;
+
+            // Only accessed by the event loop
+            std::map<int, std::shared_ptr<EpollConnection>> connections;
+            std::vector<char> readBuffer;
+
+            // Connections with queued output, guarded by flushMutex
+            std::mutex flushMutex;
+            std::vector<std::weak_ptr<EpollConnection>> flushQueue;
+
+            std::atomic<bool> stopped = false;
+            std::thread loopThread;
+
+            struct Counters {
+                std::atomic<unsigned long> openConnections = 0;
+                std::atomic<unsigned long> acceptedConnections = 0;
+                std::atomic<unsigned long> messagesIn = 0;
+                std::atomic<unsigned long> framesOut = 0;
+                std::atomic<unsigned long> epollWaits = 0;
+                std::atomic<unsigned long> epollControls = 0;
+                std::atomic<unsigned long> accepts = 0;
+                std::atomic<unsigned long> reads = 0;
+                std::atomic<unsigned long> writes = 0;
+                std::atomic<unsigned long> wakeups = 0;
+            } counters;
+
+            void run();
+
+            void acceptConnections(int listenFd, const Endpoint &endpoint);
+
+            void configureSocket(int fd, const Endpoint &endpoint) const;
+
+            /**
+             * Reads until the socket would block and handles the received handshake and frames.
+             */
+            void read(const std::shared_ptr<EpollConnection> &connection, bool hangup);
+
+            void handleHandshake(const std::shared_ptr<EpollConnection> &connection);
+
+            void handleFrames(const std::shared_ptr<EpollConnection> &connection);
+
+            void handleLengthPrefixedFrames(const std::shared_ptr<EpollConnection> &connection);
+
+            /**
+             * Writes the queued output of a connection with as few syscalls as possible.
+             */
+            FlushResult flush(EpollConnection &connection);
+
+            /**
+             * Flushes all connections whose output was queued since the last call.
+             */
+            void flushQueued();
+
+            void scheduleFlush(const std::shared_ptr<EpollConnection> &connection);
+
+            /**
+             * Queues a close frame, tries to write it and closes the connection.
+             */
+            void closeWith(const std::shared_ptr<EpollConnection> &connection, std::string lastBytes);
+
+            /**
+             * Closes the socket, the close listener is called if the handshake was completed.
+             */
+            void close(std::shared_ptr<EpollConnection> connection);
+
+            void closeSockets();
+
+            void logStatistics() const;
+    };
+}
+
+#endif //SERVER017_EPOLLTRANSPORT_HPP
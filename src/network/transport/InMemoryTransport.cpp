@@ -0,0 +1,38 @@
+/**
+ * @file   InMemoryTransport.cpp
+ * @brief  Implementation of the in-memory transport.
+ */
+
+#include "InMemoryTransport.hpp"
+
+namespace transport {
+    void InMemoryConnection::send(const std::string &message) {
+        std::lock_guard<std::mutex> lock{outboxMutex};
+        outbox.push_back(message);
+    }
+
+    void InMemoryConnection::receive(const std::string &message) {
+        receiveListener(message);
+    }
+
+    std::vector<std::string> InMemoryConnection::takeSent() {
+        std::vector<std::string> sent;
+        std::lock_guard<std::mutex> lock{outboxMutex};
+        sent.swap(outbox);
+        return sent;
+    }
+
+    std::string InMemoryTransport::description() const {
+        return "in-memory";
+    }
+
+    std::shared_ptr<InMemoryConnection> InMemoryTransport::connect() {
+        auto connection = std::make_shared<InMemoryConnection>();
+        connectionListener(connection);
+        return connection;
+    }
+
+    void InMemoryTransport::close(const std::shared_ptr<InMemoryConnection> &connection) {
+        closeListener(connection);
+    }
+}
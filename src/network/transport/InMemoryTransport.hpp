@@ -0,0 +1,57 @@
+/**
+ * @file   InMemoryTransport.hpp
+ * @brief  Transport without sockets, used to drive the server from tests and benchmarks.
+ */
+
+#ifndef SERVER017_INMEMORYTRANSPORT_HPP
+#define SERVER017_INMEMORYTRANSPORT_HPP
+
+#include <mutex>
+#include <vector>
+#include "Transport.hpp"
+
+namespace transport {
+    /**
+     * Connection whose outbound frames are collected in memory.
+     */
+    class InMemoryConnection : public Connection {
+        public:
+            void send(const std::string &message) override;
+
+            /**
+             * Hands a frame to the server as if the client had sent it.
+             * @note The server handles the frame synchronously in the calling thread.
+             */
+            void receive(const std::string &message);
+
+            /**
+             * Removes and returns all frames sent by the server since the last call.
+             */
+            std::vector<std::string> takeSent();
+
+        private:
+            // Timers of the server send from their own threads
+            std::mutex outboxMutex;
+            std::vector<std::string> outbox;
+    };
+
+    /**
+     * Transport whose connections are opened and closed by calling connect and close.
+     */
+    class InMemoryTransport : public Transport {
+        public:
+            [[nodiscard]] std::string description() const override;
+
+            /**
+             * Opens a new connection to the server.
+             */
+            std::shared_ptr<InMemoryConnection> connect();
+
+            /**
+             * Closes the connection as if the client had disconnected.
+             */
+            void close(const std::shared_ptr<InMemoryConnection> &connection);
+    };
+}
+
+#endif //SERVER017_INMEMORYTRANSPORT_HPP
@@ -0,0 +1,314 @@
+/**
+ * @file   Rfc6455.cpp
+ * @brief  Implementation of the WebSocket handshake and framing.
+ */
+
+#include "Rfc6455.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+
+namespace transport::rfc6455 {
+    namespace {
+        constexpr std::string_view handshakeGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+        uint32_t rotateLeft(uint32_t value, unsigned int bits) {
+            return (value << bits) | (value >> (32 - bits));
+        }
+
+        std::string lowercase(std::string_view text) {
+            std::string result{text};
+            std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            return result;
+        }
+
+        std::string_view trim(std::string_view text) {
+            while (not text.empty() and (text.front() == ' ' or text.front() == '\t')) {
+                text.remove_prefix(1);
+            }
+            while (not text.empty() and (text.back() == ' ' or text.back() == '\t')) {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        std::vector<std::string_view> splitList(std::string_view list) {
+            std::vector<std::string_view> items;
+            while (not list.empty()) {
+                auto comma = list.find(',');
+                auto item = trim(list.substr(0, comma));
+                if (not item.empty()) {
+                    items.push_back(item);
+                }
+                if (comma == std::string_view::npos) {
+                    break;
+                }
+                list.remove_prefix(comma + 1);
+            }
+            return items;
+        }
+
+        bool listContains(std::string_view list, std::string_view token) {
+            auto items = splitList(list);
+            return std::any_of(items.begin(), items.end(), [&token](std::string_view item) {
+                return lowercase(item) == token;
+            });
+        }
+    }
+
+    std::string sha1(std::string_view data) {
+        std::array<uint32_t, 5> h = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+        std::string message{data};
+        uint64_t bitLength = static_cast<uint64_t>(data.size()) * 8;
+        message += static_cast<char>(0x80);
+        while (message.size() % 64 != 56) {
+            message += '\0';
+        }
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            message += static_cast<char>((bitLength >> static_cast<unsigned int>(shift)) & 0xFF);
+        }
+
+        for (std::size_t chunk = 0; chunk < message.size(); chunk += 64) {
+            std::array<uint32_t, 80> w{};
+            for (std::size_t i = 0; i < 16; i++) {
+                for (std::size_t b = 0; b < 4; b++) {
+                    w.at(i) = (w.at(i) << 8) | static_cast<unsigned char>(message.at(chunk + i * 4 + b));
+                }
+            }
+            for (std::size_t i = 16; i < 80; i++) {
+                w.at(i) = rotateLeft(w.at(i - 3) ^ w.at(i - 8) ^ w.at(i - 14) ^ w.at(i - 16), 1);
+            }
+
+            auto [a, b, c, d, e] = h;
+            for (std::size_t i = 0; i < 80; i++) {
+                uint32_t f;
+                uint32_t k;
+                if (i < 20) {
+                    f = (b & c) | (~b & d);
+                    k = 0x5A827999;
+                } else if (i < 40) {
+                    f = b ^ c ^ d;
+                    k = 0x6ED9EBA1;
+                } else if (i < 60) {
+                    f = (b & c) | (b & d) | (c & d);
+                    k = 0x8F1BBCDC;
+                } else {
+                    f = b ^ c ^ d;
+                    k = 0xCA62C1D6;
+                }
+                uint32_t temp = rotateLeft(a, 5) + f + e + k + w.at(i);
+                e = d;
+                d = c;
+                c = rotateLeft(b, 30);
+                b = a;
+                a = temp;
+            }
+            h.at(0) += a;
+            h.at(1) += b;
+            h.at(2) += c;
+            h.at(3) += d;
+            h.at(4) += e;
+        }
+
+        std::string digest;
+        for (auto word : h) {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                digest += static_cast<char>((word >> static_cast<unsigned int>(shift)) & 0xFF);
+            }
+        }
+        return digest;
+    }
+
+    std::string base64(std::string_view data) {
+        constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string encoded;
+        encoded.reserve((data.size() + 2) / 3 * 4);
+        for (std::size_t i = 0; i < data.size(); i += 3) {
+            uint32_t group = static_cast<uint32_t>(static_cast<unsigned char>(data.at(i))) << 16;
+            if (i + 1 < data.size()) {
+                group |= static_cast<uint32_t>(static_cast<unsigned char>(data.at(i + 1))) << 8;
+            }
+            if (i + 2 < data.size()) {
+                group |= static_cast<unsigned char>(data.at(i + 2));
+            }
+            encoded += alphabet.at((group >> 18) & 0x3F);
+            encoded += alphabet.at((group >> 12) & 0x3F);
+            encoded += i + 1 < data.size() ? alphabet.at((group >> 6) & 0x3F) : '=';
+            encoded += i + 2 < data.size() ? alphabet.at(group & 0x3F) : '=';
+        }
+        return encoded;
+    }
+
+    std::string acceptKey(std::string_view key) {
+        std::string input{key};
+        input += handshakeGuid;
+        return base64(sha1(input));
+    }
+
+    std::optional<HandshakeRequest> parseHandshake(std::string_view request) {
+        auto lineEnd = request.find("\r\n");
+        if (lineEnd == std::string_view::npos or request.substr(0, 4) != "GET ") {
+            return std::nullopt;
+        }
+
+        bool upgrade = false;
+        bool connectionUpgrade = false;
+        bool version13 = false;
+        HandshakeRequest handshake;
+        while (true) {
+            request.remove_prefix(lineEnd + 2);
+            lineEnd = request.find("\r\n");
+            if (lineEnd == std::string_view::npos or lineEnd == 0) {
+                break;
+            }
+            auto line = request.substr(0, lineEnd);
+            auto colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                return std::nullopt;
+            }
+            auto name = lowercase(trim(line.substr(0, colon)));
+            auto value = trim(line.substr(colon + 1));
+
+            if (name == "upgrade") {
+                upgrade = listContains(value, "websocket");
+            } else if (name == "connection") {
+                connectionUpgrade = listContains(value, "upgrade");
+            } else if (name == "sec-websocket-version") {
+                version13 = value == "13";
+            } else if (name == "sec-websocket-key") {
+                handshake.key = std::string{value};
+            } else if (name == "sec-websocket-protocol") {
+                for (auto protocol : splitList(value)) {
+                    handshake.protocols.emplace_back(protocol);
+                }
+            }
+        }
+
+        if (not upgrade or not connectionUpgrade or not version13 or handshake.key.empty()) {
+            return std::nullopt;
+        }
+        return handshake;
+    }
+
+    std::string handshakeResponse(const HandshakeRequest &request, const std::string &protocol) {
+        std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+                               "Upgrade: websocket\r\n"
+                               "Connection: Upgrade\r\n"
+                               "Sec-WebSocket-Accept: " + acceptKey(request.key) + "\r\n";
+        if (not protocol.empty() and
+            std::find(request.protocols.begin(), request.protocols.end(), protocol) != request.protocols.end()) {
+            response += "Sec-WebSocket-Protocol: " + protocol + "\r\n";
+        }
+        response += "\r\n";
+        return response;
+    }
+
+    std::string handshakeRejection() {
+        return "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    }
+
+    std::string encodeFrame(Opcode opcode, std::string_view payload) {
+        std::string frame;
+        frame.reserve(payload.size() + 10);
+        frame += static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+        if (payload.size() < 126) {
+            frame += static_cast<char>(payload.size());
+        } else if (payload.size() <= 0xFFFF) {
+            frame += static_cast<char>(126);
+            frame += static_cast<char>((payload.size() >> 8) & 0xFF);
+            frame += static_cast<char>(payload.size() & 0xFF);
+        } else {
+            frame += static_cast<char>(127);
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                frame += static_cast<char>((static_cast<uint64_t>(payload.size()) >> static_cast<unsigned int>(shift))
+                                           & 0xFF);
+            }
+        }
+        frame += payload;
+        return frame;
+    }
+
+    std::string encodeClose(CloseCode code) {
+        auto value = static_cast<uint16_t>(code);
+        std::string payload;
+        payload += static_cast<char>(value >> 8);
+        payload += static_cast<char>(value & 0xFF);
+        return encodeFrame(Opcode::close, payload);
+    }
+
+    ParseResult parseFrame(std::string_view buffer, std::size_t &offset, Frame &frame, std::size_t maxPayload) {
+        auto available = buffer.substr(offset);
+        if (available.size() < 2) {
+            return ParseResult::incomplete;
+        }
+
+        auto first = static_cast<uint8_t>(available.at(0));
+        auto second = static_cast<uint8_t>(available.at(1));
+        bool fin = (first & 0x80) != 0;
+        auto opcode = static_cast<Opcode>(first & 0x0F);
+        bool masked = (second & 0x80) != 0;
+
+        // Extensions are not negotiated, so the RSV bits have to be zero; clients have to mask their frames
+        if ((first & 0x70) != 0 or not masked) {
+            return ParseResult::protocolError;
+        }
+        switch (opcode) {
+            case Opcode::continuation:
+            case Opcode::text:
+            case Opcode::binary:
+                break;
+            case Opcode::close:
+            case Opcode::ping:
+            case Opcode::pong:
+                // Control frames must not be fragmented and are limited to 125 bytes
+                if (not fin or (second & 0x7F) > 125) {
+                    return ParseResult::protocolError;
+                }
+                break;
+            default:
+                return ParseResult::protocolError;
+        }
+
+        std::size_t headerSize = 2;
+        uint64_t payloadSize = second & 0x7F;
+        if (payloadSize == 126 or payloadSize == 127) {
+            std::size_t lengthBytes = payloadSize == 126 ? 2 : 8;
+            if (available.size() < headerSize + lengthBytes) {
+                return ParseResult::incomplete;
+            }
+            payloadSize = 0;
+            for (std::size_t i = 0; i < lengthBytes; i++) {
+                payloadSize = (payloadSize << 8) | static_cast<uint8_t>(available.at(headerSize + i));
+            }
+            headerSize += lengthBytes;
+        }
+        if (payloadSize > maxPayload) {
+            return ParseResult::tooLarge;
+        }
+
+        std::array<uint8_t, 4> mask{};
+        if (available.size() < headerSize + mask.size()) {
+            return ParseResult::incomplete;
+        }
+        for (std::size_t i = 0; i < mask.size(); i++) {
+            mask.at(i) = static_cast<uint8_t>(available.at(headerSize + i));
+        }
+        headerSize += mask.size();
+
+        if (available.size() < headerSize + payloadSize) {
+            return ParseResult::incomplete;
+        }
+
+        frame.fin = fin;
+        frame.opcode = opcode;
+        frame.payload.assign(available.substr(headerSize, payloadSize));
+        for (std::size_t i = 0; i < frame.payload.size(); i++) {
+            frame.payload[i] = static_cast<char>(static_cast<uint8_t>(frame.payload[i]) ^ mask[i % 4]);
+        }
+        offset += headerSize + payloadSize;
+        return ParseResult::frame;
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * @file   Rfc6455.hpp
+ * @brief  Opening handshake and framing of the WebSocket protocol (RFC 6455), server side.
+ */
+
+#ifndef SERVER017_RFC6455_HPP
+#define SERVER017_RFC6455_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace transport::rfc6455 {
+    enum class Opcode : uint8_t {
+        continuation = 0x0,
+        text = 0x1,
+        binary = 0x2,
+        close = 0x8,
+        ping = 0x9,
+        pong = 0xA
+    };
+
+    /**
+     * Status codes sent in close frames.
+     */
+    enum class CloseCode : uint16_t {
+        normal = 1000,
+        protocolError = 1002,
+        messageTooBig = 1009
+    };
+
+    /**
+     * @return SHA-1 digest of the data, 20 bytes
+     */
+    std::string sha1(std::string_view data);
+
+    std::string base64(std::string_view data);
+
+    /**
+     * @return Value of the Sec-WebSocket-Accept header for the Sec-WebSocket-Key of a client
+     */
+    std::string acceptKey(std::string_view key);
+
+    struct HandshakeRequest {
+        std::string key;
+        std::vector<std::string> protocols;
+    };
+
+    /**
+     * Parses the HTTP upgrade request of a client.
+     * @param request Request including the terminating empty line
+     * @return Nothing if the request is no valid WebSocket upgrade request
+     */
+    std::optional<HandshakeRequest> parseHandshake(std::string_view request);
+
+    /**
+     * @param protocol Subprotocol to confirm, omitted if empty
+     * @return HTTP 101 response accepting the upgrade
+     */
+    std::string handshakeResponse(const HandshakeRequest &request, const std::string &protocol);
+
+    /**
+     * @return HTTP 400 response rejecting a malformed upgrade request
+     */
+    std::string handshakeRejection();
+
+    /**
+     * @return Unmasked frame with the FIN bit set, as sent by a server
+     */
+    std::string encodeFrame(Opcode opcode, std::string_view payload);
+
+    /**
+     * @return Close frame with the given status code
+     */
+    std::string encodeClose(CloseCode code);
+
+    struct Frame {
+        bool fin = false;
+        Opcode opcode = Opcode::continuation;
+        std::string payload;
+    };
+
+    enum class ParseResult {
+        frame,
+        incomplete,
+        protocolError,
+        tooLarge
+    };
+
+    /**
+     * Parses and unmasks a single client frame.
+     * @param buffer     Received bytes
+     * @param offset     Start of the frame in the buffer, advanced behind the frame if one was parsed
+     * @param frame      Set if a frame was parsed
+     * @param maxPayload Maximum payload length accepted
+     */
+    ParseResult parseFrame(std::string_view buffer, std::size_t &offset, Frame &frame, std::size_t maxPayload);
+}
+
+#endif //SERVER017_RFC6455_HPP
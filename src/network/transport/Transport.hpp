@@ -0,0 +1,50 @@
+/**
+ * @file   Transport.hpp
+ * @brief  Interfaces of the transport layer below the MessageRouter.
+ */
+
+#ifndef SERVER017_TRANSPORT_HPP
+#define SERVER017_TRANSPORT_HPP
+
+#include <memory>
+#include <string>
+#include <Util/Listener.hpp>
+#include "../ForwardingListener.hpp"
+
+namespace transport {
+    /**
+     * A single client connection of a transport. Frames received from the client are emitted via the
+     * receiveListener, which passes them by reference to its only subscriber (the MessageRouter).
+     */
+    class Connection {
+        public:
+            virtual ~Connection() = default;
+
+            /**
+             * Sends a single frame to the client.
+             */
+            virtual void send(const std::string &message) = 0;
+
+            const ForwardingListener<const std::string &> receiveListener;
+    };
+
+    /**
+     * Accepts client connections and reports new and closed connections to the MessageRouter.
+     */
+    class Transport {
+        public:
+            using connectionPtr = std::shared_ptr<Connection>;
+
+            virtual ~Transport() = default;
+
+            /**
+             * Human readable description of the transport, used for logging.
+             */
+            [[nodiscard]] virtual std::string description() const = 0;
+
+            const websocket::util::Listener<connectionPtr> connectionListener;
+            const websocket::util::Listener<connectionPtr> closeListener;
+    };
+}
+
+#endif //SERVER017_TRANSPORT_HPP
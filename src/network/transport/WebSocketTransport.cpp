@@ -0,0 +1,55 @@
+/**
+ * @file   WebSocketTransport.cpp
+ * @brief  Implementation of the websocket transport.
+ */
+
+#include "WebSocketTransport.hpp"
+
+namespace transport {
+    WebSocketTransport::WebSocketConnection::WebSocketConnection(webSocketConnectionPtr connection) :
+            connection{std::move(connection)} {}
+
+    void WebSocketTransport::WebSocketConnection::send(const std::string &message) {
+        connection->send(message);
+    }
+
+    WebSocketTransport::WebSocketTransport(uint16_t port, std::string protocol) :
+            port{port},
+            server{port, std::move(protocol)} {
+        server.connectionListener.subscribe([this](const webSocketConnectionPtr &newConnection) {
+            auto wrapped = std::make_shared<WebSocketConnection>(newConnection);
+            {
+                std::lock_guard<std::mutex> lock{connectionMutex};
+                connections.emplace(newConnection, wrapped);
+            }
+
+            std::weak_ptr<WebSocketConnection> weakWrapped = wrapped;
+            newConnection->receiveListener.subscribe([weakWrapped](const std::string &message) {
+                if (auto c = weakWrapped.lock()) {
+                    c->receiveListener(message);
+                }
+            });
+
+            connectionListener(wrapped);
+        });
+
+        server.closeListener.subscribe([this](const webSocketConnectionPtr &closedConnection) {
+            std::shared_ptr<WebSocketConnection> wrapped;
+            {
+                std::lock_guard<std::mutex> lock{connectionMutex};
+                auto it = connections.find(closedConnection);
+                if (it == connections.end()) {
+                    return;
+                }
+                wrapped = it->second;
+                connections.erase(it);
+            }
+
+            closeListener(wrapped);
+        });
+    }
+
+    std::string WebSocketTransport::description() const {
+        return "websocket on port " + std::to_string(port);
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * @file   WebSocketTransport.hpp
+ * @brief  Transport accepting clients via websocket::network::WebSocketServer.
+ */
+
+#ifndef SERVER017_WEBSOCKETTRANSPORT_HPP
+#define SERVER017_WEBSOCKETTRANSPORT_HPP
+
+#include <map>
+#include <mutex>
+#include <Server/WebSocketServer.hpp>
+#include "Transport.hpp"
+
+namespace transport {
+    /**
+     * Adapts the connections of a websocket::network::WebSocketServer to the transport interface.
+     */
+    class WebSocketTransport : public Transport {
+        public:
+            WebSocketTransport(uint16_t port, std::string protocol);
+
+            [[nodiscard]] std::string description() const override;
+
+        private:
+            using webSocketConnectionPtr = std::shared_ptr<websocket::network::Connection>;
+
+            class WebSocketConnection : public Connection {
+                public:
+                    explicit WebSocketConnection(webSocketConnectionPtr connection);
+
+                    void send(const std::string &message) override;
+
+                private:
+                    webSocketConnectionPtr connection;
+            };
+
+            uint16_t port;
+
+            // Guards connections, the websocket server reports connections from its own threads
+            std::mutex connectionMutex;
+            std::map<webSocketConnectionPtr, std::shared_ptr<WebSocketConnection>> connections;
+
+            // Declared last so the server is stopped before the connections are destroyed
+            websocket::network::WebSocketServer server;
+    };
+}
+
+#endif //SERVER017_WEBSOCKETTRANSPORT_HPP
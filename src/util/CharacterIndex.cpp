@@ -0,0 +1,53 @@
+/**
+ * @file   CharacterIndex.cpp
+ * @brief  Implementation of the character index.
+ */
+
+#include "CharacterIndex.hpp"
+#include <algorithm>
+
+void CharacterIndex::rebuild(spy::character::CharacterSet &characters) {
+    slots.clear();
+    for (auto &character : characters) {
+        slots.emplace_back(character.getCharacterId(), &character);
+    }
+    std::sort(slots.begin(), slots.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
+    });
+
+    indexedSet = &characters;
+    firstCharacter = slots.empty() ? nullptr : &*characters.begin();
+}
+
+spy::character::Character *CharacterIndex::find(spy::character::CharacterSet &characters,
+                                                 const spy::util::UUID &id) {
+    if (not isCurrent(characters)) {
+        rebuild(characters);
+        return lookup(id);
+    }
+
+    auto character = lookup(id);
+    if (character == nullptr or character->getCharacterId() == id) {
+        return character;
+    }
+    // The set was assigned without changing its size, the slots hold other characters
+    rebuild(characters);
+    return lookup(id);
+}
+
+bool CharacterIndex::isCurrent(const spy::character::CharacterSet &characters) const {
+    if (indexedSet != &characters or slots.size() != characters.size()) {
+        return false;
+    }
+    return slots.empty() or firstCharacter == &*characters.begin();
+}
+
+spy::character::Character *CharacterIndex::lookup(const spy::util::UUID &id) const {
+    auto slot = std::lower_bound(slots.begin(), slots.end(), id, [](const auto &entry, const spy::util::UUID &key) {
+        return entry.first < key;
+    });
+    if (slot == slots.end() or not (slot->first == id)) {
+        return nullptr;
+    }
+    return slot->second;
+}
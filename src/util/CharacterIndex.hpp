@@ -0,0 +1,42 @@
+/**
+ * @file   CharacterIndex.hpp
+ * @brief  Index of the characters of the game state by UUID.
+ */
+
+#ifndef SERVER017_CHARACTER_INDEX_HPP
+#define SERVER017_CHARACTER_INDEX_HPP
+
+#include <utility>
+#include <vector>
+#include <datatypes/character/CharacterSet.hpp>
+#include <util/UUID.hpp>
+
+/**
+ * Maps the UUIDs of the characters of a CharacterSet to the characters in the set, replacing the linear search
+ * of CharacterSet::findByUUID. The slots are kept in one array sorted by UUID.
+ *
+ * The index is built for one set and has to be rebuilt whenever characters are added to or removed from it or the
+ * set is assigned, e.g. when the character set of a game is created, restored or the NPCs leave. As a safeguard,
+ * find rebuilds the index itself if the set was resized or moved since, or if the slot of the UUID holds
+ * another character.
+ */
+class CharacterIndex {
+    public:
+        void rebuild(spy::character::CharacterSet &characters);
+
+        /**
+         * @return Character with the UUID in the set, nullptr if the set has no such character
+         */
+        spy::character::Character *find(spy::character::CharacterSet &characters, const spy::util::UUID &id);
+
+    private:
+        std::vector<std::pair<spy::util::UUID, spy::character::Character *>> slots;
+        const spy::character::CharacterSet *indexedSet = nullptr;
+        const spy::character::Character *firstCharacter = nullptr;
+
+        [[nodiscard]] bool isCurrent(const spy::character::CharacterSet &characters) const;
+
+        [[nodiscard]] spy::character::Character *lookup(const spy::util::UUID &id) const;
+};
+
+#endif //SERVER017_CHARACTER_INDEX_HPP
@@ -0,0 +1,101 @@
+/**
+ * @file   Clock.cpp
+ * @brief  Implementation of the system and the virtual clock.
+ */
+
+#include "Clock.hpp"
+#include <algorithm>
+#include <thread>
+
+auto SystemClock::now() const -> time_point {
+    return std::chrono::system_clock::now();
+}
+
+void SystemClock::schedule(duration timeout, std::shared_ptr<bool> cancelled, std::function<void()> function) {
+    std::thread timerThread{[timeout, cancelled = std::move(cancelled), function = std::move(function)]() {
+        std::this_thread::sleep_for(timeout);
+        if (not *cancelled) {
+            function();
+        }
+    }};
+    timerThread.detach();
+}
+
+VirtualClock::VirtualClock(time_point start) : currentTime{start} {}
+
+auto VirtualClock::now() const -> time_point {
+    std::lock_guard<std::mutex> lock{mutex};
+    return currentTime;
+}
+
+/**
+ * Adds a duration to a time point without overflowing, timers without limit use the maximum duration.
+ */
+static Clock::time_point saturatingAdd(Clock::time_point t, Clock::duration d) {
+    if (d > Clock::time_point::max() - t) {
+        return Clock::time_point::max();
+    }
+    return t + d;
+}
+
+void VirtualClock::schedule(duration timeout, std::shared_ptr<bool> cancelled, std::function<void()> function) {
+    std::lock_guard<std::mutex> lock{mutex};
+
+    if (scheduled.size() >= pruneThreshold) {
+        for (auto it = scheduled.begin(); it != scheduled.end();) {
+            it = *it->second.cancelled ? scheduled.erase(it) : std::next(it);
+        }
+        pruneThreshold = std::max(pruneThreshold, 2 * scheduled.size());
+    }
+
+    scheduled.emplace(key{saturatingAdd(currentTime, timeout), nextSequence++},
+                      Entry{std::move(cancelled), std::move(function)});
+}
+
+auto VirtualClock::popDue(time_point until) -> std::optional<std::pair<key, Entry>> {
+    std::lock_guard<std::mutex> lock{mutex};
+    while (not scheduled.empty() and scheduled.begin()->first.first <= until) {
+        auto entry = scheduled.extract(scheduled.begin());
+        currentTime = std::max(currentTime, entry.key().first);
+        if (not *entry.mapped().cancelled) {
+            return std::make_pair(entry.key(), std::move(entry.mapped()));
+        }
+    }
+    return std::nullopt;
+}
+
+std::size_t VirtualClock::advance(duration timeSpan) {
+    time_point until;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        until = saturatingAdd(currentTime, timeSpan);
+    }
+
+    // The lock is not held while executing, the functions may schedule further timers
+    std::size_t executed = 0;
+    while (auto due = popDue(until)) {
+        due->second.function();
+        executed++;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+    currentTime = std::max(currentTime, until);
+    return executed;
+}
+
+auto VirtualClock::nextExpiry() const -> std::optional<time_point> {
+    std::lock_guard<std::mutex> lock{mutex};
+    for (const auto &[k, entry] : scheduled) {
+        if (not *entry.cancelled) {
+            return k.first;
+        }
+    }
+    return std::nullopt;
+}
+
+std::size_t VirtualClock::pending() const {
+    std::lock_guard<std::mutex> lock{mutex};
+    return static_cast<std::size_t>(std::count_if(scheduled.begin(), scheduled.end(), [](const auto &entry) {
+        return not *entry.second.cancelled;
+    }));
+}
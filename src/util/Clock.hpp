@@ -0,0 +1,98 @@
+/**
+ * @file   Clock.hpp
+ * @brief  Time source of the server timers, either the system clock or a manually advanced virtual clock.
+ */
+
+#ifndef SERVER017_CLOCK_HPP
+#define SERVER017_CLOCK_HPP
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+/**
+ * Source of the current time and of deferred function calls for the Timer.
+ */
+class Clock {
+    public:
+        using duration = std::chrono::system_clock::duration;
+        using time_point = std::chrono::system_clock::time_point;
+
+        virtual ~Clock() = default;
+
+        [[nodiscard]] virtual time_point now() const = 0;
+
+        /**
+         * Calls a function once the timeout has passed.
+         * @param timeout   Time until the function is called
+         * @param cancelled The function is not called if this is true once the timeout has passed
+         * @param function  Function to call
+         */
+        virtual void schedule(duration timeout, std::shared_ptr<bool> cancelled, std::function<void()> function) = 0;
+};
+
+/**
+ * Clock using the system time, every scheduled function call waits in a thread of its own.
+ */
+class SystemClock : public Clock {
+    public:
+        [[nodiscard]] time_point now() const override;
+
+        void schedule(duration timeout, std::shared_ptr<bool> cancelled, std::function<void()> function) override;
+};
+
+/**
+ * Clock that only moves when advance is called. Scheduled functions are executed by advance in the calling
+ * thread, in order of their expiry, so timeout scenarios run deterministically and without waiting.
+ */
+class VirtualClock : public Clock {
+    public:
+        explicit VirtualClock(time_point start = time_point{});
+
+        [[nodiscard]] time_point now() const override;
+
+        void schedule(duration timeout, std::shared_ptr<bool> cancelled, std::function<void()> function) override;
+
+        /**
+         * Moves the time forward and executes all functions that are due until then.
+         * @return Number of executed functions
+         */
+        std::size_t advance(duration timeSpan);
+
+        /**
+         * Expiry of the next scheduled function that is not cancelled, if there is one.
+         */
+        [[nodiscard]] std::optional<time_point> nextExpiry() const;
+
+        /**
+         * Number of scheduled functions that are neither executed nor cancelled.
+         */
+        [[nodiscard]] std::size_t pending() const;
+
+    private:
+        struct Entry {
+            std::shared_ptr<bool> cancelled;
+            std::function<void()> function;
+        };
+
+        // Key is expiry and insertion order, so functions with the same expiry run in the order they were scheduled
+        using key = std::pair<time_point, unsigned long>;
+
+        mutable std::mutex mutex;
+        time_point currentTime;
+        unsigned long nextSequence = 0;
+        std::map<key, Entry> scheduled;
+
+        // Cancelled entries are removed lazily once the map has grown to this size
+        std::size_t pruneThreshold = 64;
+
+        /**
+         * Removes and returns the first entry due until the given time.
+         */
+        std::optional<std::pair<key, Entry>> popDue(time_point until);
+};
+
+#endif //SERVER017_CLOCK_HPP
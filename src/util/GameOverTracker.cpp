@@ -0,0 +1,45 @@
+/**
+ * @file   GameOverTracker.cpp
+ * @brief  Implementation of the game over tracker.
+ */
+
+#include "GameOverTracker.hpp"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include <datatypes/gameplay/GadgetAction.hpp>
+#include <util/RoundUtils.hpp>
+
+void GameOverTracker::evaluate(const spy::gameplay::State &state) {
+    gameOver = spy::util::RoundUtils::isGameOver(state);
+}
+
+void GameOverTracker::update(const spy::gameplay::State &state,
+                             const std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>> &executed) {
+    using spy::gameplay::OperationEnum;
+
+    bool canEndGame = std::any_of(executed.begin(), executed.end(), [](const auto &operation) {
+        if (operation->getType() == OperationEnum::JANITOR_ACTION) {
+            return true;
+        }
+        if (operation->getType() != OperationEnum::GADGET_ACTION) {
+            return false;
+        }
+        auto gadgetAction = std::dynamic_pointer_cast<const spy::gameplay::GadgetAction>(operation);
+        return gadgetAction != nullptr and gadgetAction->getGadget() == spy::gadget::GadgetEnum::DIAMOND_COLLAR;
+    });
+
+    if (canEndGame) {
+        evaluate(state);
+    }
+}
+
+bool GameOverTracker::isGameOver([[maybe_unused]] const spy::gameplay::State &state) const {
+#ifndef NDEBUG
+    bool evaluated = spy::util::RoundUtils::isGameOver(state);
+    if (evaluated != gameOver) {
+        spdlog::error("Tracked game over condition ({}) differs from the state ({})", gameOver, evaluated);
+        return evaluated;
+    }
+#endif
+    return gameOver;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file   GameOverTracker.hpp
+ * @brief  Game over condition of the current game, evaluated only when it can change.
+ */
+
+#ifndef SERVER017_GAME_OVER_TRACKER_HPP
+#define SERVER017_GAME_OVER_TRACKER_HPP
+
+#include <memory>
+#include <vector>
+#include <datatypes/gameplay/State.hpp>
+#include <datatypes/gameplay/BaseOperation.hpp>
+
+/**
+ * Caches RoundUtils::isGameOver for the game state. A game ends when the white cat receives the diamond collar
+ * or the janitor has removed all characters, so the condition is only evaluated again after a diamond collar
+ * gadget action, after janitor moves and at the beginning of a round. All other checks of the condition
+ * (after every operation and FSM event) read the cached value.
+ *
+ * In debug builds, every check is compared with the full evaluation of the state and a mismatch is logged.
+ */
+class GameOverTracker {
+    public:
+        /**
+         * Evaluates the game over condition for the state, e.g. at the beginning of a game or a round.
+         */
+        void evaluate(const spy::gameplay::State &state);
+
+        /**
+         * Evaluates the game over condition again if one of the executed operations can end the game.
+         * @param executed Operations executed since the last update, including their consequences
+         */
+        void update(const spy::gameplay::State &state,
+                    const std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>> &executed);
+
+        /**
+         * @param state State the tracker was updated with, only used for the cross-check in debug builds
+         */
+        [[nodiscard]] bool isGameOver(const spy::gameplay::State &state) const;
+
+    private:
+        bool gameOver = false;
+};
+
+#endif //SERVER017_GAME_OVER_TRACKER_HPP
@@ -0,0 +1,96 @@
+/**
+ * @file   GameStatePool.cpp
+ * @brief  Implementation of the pool of prepared games.
+ */
+
+#include "GameStatePool.hpp"
+#include <algorithm>
+#include <numeric>
+#include <spdlog/spdlog.h>
+
+GameStatePool::GameStatePool(std::shared_ptr<const ScenarioLayout> layout, unsigned int minChips,
+                             unsigned int maxChips, std::size_t capacity, unsigned int seed) :
+        layout{std::move(layout)},
+        minChips{minChips},
+        maxChips{maxChips},
+        capacity{capacity},
+        backgroundRng{seed},
+        takeRng{seed + 1} {
+    if (capacity > 0) {
+        worker = std::thread{&GameStatePool::run, this};
+    }
+}
+
+GameStatePool::~GameStatePool() {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopped = true;
+    }
+    refill.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+auto GameStatePool::take() -> PreparedGame {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (not ready.empty()) {
+            auto game = std::move(ready.front());
+            ready.pop_front();
+            refill.notify_one();
+            return game;
+        }
+        missCount++;
+    }
+    if (capacity > 0) {
+        spdlog::debug("No prepared game available, preparing the game now");
+    }
+    return prepare(takeRng);
+}
+
+unsigned long GameStatePool::misses() const {
+    std::lock_guard<std::mutex> lock{mutex};
+    return missCount;
+}
+
+auto GameStatePool::prepare(std::mt19937 &rng) const -> PreparedGame {
+    PreparedGame game{layout->createMap(), layout->getAccessibleFields()};
+
+    // Safes are numbered from 1 and get their numbers in random order
+    std::vector<unsigned int> safeIndexes(layout->getSafes().size());
+    std::iota(safeIndexes.begin(), safeIndexes.end(), 1);
+    std::shuffle(safeIndexes.begin(), safeIndexes.end(), rng);
+    auto indexIterator = safeIndexes.begin();
+
+    std::uniform_int_distribution<unsigned int> randChips(minChips, maxChips);
+    game.map.forAllFields([&rng, &randChips, &indexIterator](spy::scenario::Field &field) {
+        if (field.getFieldState() == spy::scenario::FieldStateEnum::ROULETTE_TABLE) {
+            field.setChipAmount(randChips(rng));
+        } else if (field.getFieldState() == spy::scenario::FieldStateEnum::SAFE) {
+            field.setSafeIndex(*indexIterator);
+            indexIterator++;
+        }
+    });
+
+    // Taking the fields in this order places every character on a random free field
+    std::shuffle(game.placements.begin(), game.placements.end(), rng);
+    return game;
+}
+
+void GameStatePool::run() {
+    std::unique_lock<std::mutex> lock{mutex};
+    while (true) {
+        refill.wait(lock, [this] {
+            return stopped or ready.size() < capacity;
+        });
+        if (stopped) {
+            return;
+        }
+
+        lock.unlock();
+        auto game = prepare(backgroundRng);
+        lock.lock();
+        ready.push_back(std::move(game));
+    }
+}
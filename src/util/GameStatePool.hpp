@@ -0,0 +1,77 @@
+/**
+ * @file   GameStatePool.hpp
+ * @brief  Background preparation of the randomized parts of new games.
+ */
+
+#ifndef SERVER017_GAME_STATE_POOL_HPP
+#define SERVER017_GAME_STATE_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "ScenarioLayout.hpp"
+
+/**
+ * Keeps a number of prepared games ready, so entering the game phase does not have to roll the chips, shuffle
+ * the safes and search fields for the characters. Games are prepared by a background thread, which refills the
+ * pool whenever a game is taken.
+ */
+class GameStatePool {
+    public:
+        static constexpr std::size_t defaultCapacity = 1;
+
+        struct PreparedGame {
+            spy::scenario::FieldMap map;                //!< Chips on the roulette tables, safes with shuffled indices
+            std::vector<spy::util::Point> placements;  //!< All accessible fields in random order
+        };
+
+        /**
+         * @param capacity Number of games kept ready, with 0 games are prepared when they are taken
+         * @param seed     Seed of the random numbers used for the games
+         */
+        GameStatePool(std::shared_ptr<const ScenarioLayout> layout, unsigned int minChips, unsigned int maxChips,
+                      std::size_t capacity, unsigned int seed);
+
+        GameStatePool(const GameStatePool &other) = delete;
+
+        GameStatePool &operator=(const GameStatePool &other) = delete;
+
+        /**
+         * Stops the background thread.
+         */
+        ~GameStatePool();
+
+        /**
+         * Takes a prepared game from the pool, or prepares one in the calling thread if the pool is empty.
+         */
+        PreparedGame take();
+
+        /**
+         * @return Number of games that had to be prepared by take()
+         */
+        [[nodiscard]] unsigned long misses() const;
+
+    private:
+        std::shared_ptr<const ScenarioLayout> layout;
+        unsigned int minChips;
+        unsigned int maxChips;
+        std::size_t capacity;
+
+        std::mt19937 backgroundRng;
+        std::mt19937 takeRng; //!< Used by take() if the pool is empty
+
+        mutable std::mutex mutex;
+        std::condition_variable refill;
+        std::deque<PreparedGame> ready;
+        unsigned long missCount = 0;
+        bool stopped = false;
+        std::thread worker;
+
+        PreparedGame prepare(std::mt19937 &rng) const;
+
+        void run();
+};
+
+#endif //SERVER017_GAME_STATE_POOL_HPP
@@ -0,0 +1,132 @@
+/**
+ * @file   MatchRecorder.cpp
+ * @brief  Implementation of the match recorder.
+ */
+
+#include "MatchRecorder.hpp"
+#include <ctime>
+#include <spdlog/spdlog.h>
+#include <network/MessageContainer.hpp>
+#include <util/RoundUtils.hpp>
+
+/**
+ * Formats a point in time like the creation date of messages.
+ */
+static std::string formatDate(Clock::time_point timePoint) {
+    std::string date(20, '\0');
+    struct tm buf = {};
+    std::time_t time = std::chrono::system_clock::to_time_t(timePoint);
+    auto length = std::strftime(&date[0], date.size(), "%d.%m.%Y %H:%M:%S", localtime_r(&time, &buf));
+    date.resize(length);
+    return date;
+}
+
+void MatchRecorder::start(const spy::util::UUID &session,
+                          const std::map<Player, spy::util::UUID> &ids,
+                          const std::map<Player, std::string> &names,
+                          Clock::time_point startTime) {
+    status = Status::recording;
+    sessionId = session;
+    playerIds = ids;
+    playerNames = names;
+    gameStart = formatDate(startTime);
+    gameEnd.clear();
+    rounds = 0;
+    currentOperations.clear();
+    recordedRounds.clear();
+    lastState = nullptr;
+}
+
+void MatchRecorder::addOperations(const operationList &operations) {
+    if (status != Status::recording) {
+        return;
+    }
+    currentOperations.insert(currentOperations.end(), operations.begin(), operations.end());
+}
+
+void MatchRecorder::finishRound(const spy::util::UUID &activeCharacter, const spy::gameplay::State &state) {
+    if (status != Status::recording) {
+        return;
+    }
+
+    nlohmann::json roundStatus = spy::network::messages::GameStatus{{}, activeCharacter, currentOperations, state,
+                                                                     spy::util::RoundUtils::isGameOver(state)};
+    nlohmann::json roundState = std::move(roundStatus.at("state"));
+    roundStatus.erase("state");
+    roundState["mySafeCombinations"] = nlohmann::json::array();
+
+    // the first round is recorded as patch against null, i.e. the complete state
+    recordedRounds.push_back({roundStatus.dump(), nlohmann::json::diff(lastState, roundState).dump()});
+    lastState = std::move(roundState);
+
+    rounds = state.getCurrentRound();
+    currentOperations.clear();
+}
+
+void MatchRecorder::finish(const spy::gameplay::State &state, Clock::time_point endTime) {
+    if (status != Status::recording) {
+        return;
+    }
+
+    if (state.getCurrentRound() == 0) {
+        // game ended before the game phase, nothing to replay
+        status = Status::empty;
+        return;
+    }
+
+    finishRound({}, state);
+    gameEnd = formatDate(endTime);
+    recordedRounds.shrink_to_fit();
+    lastState = nullptr;
+    status = Status::finished;
+    spdlog::info("Recorded {} rounds for the replay in {} bytes", recordedRounds.size(), memoryUsage());
+}
+
+bool MatchRecorder::hasReplay() const {
+    return status == Status::finished;
+}
+
+std::string MatchRecorder::createReplay(const spy::util::UUID &clientId,
+                                        const spy::scenario::Scenario &level,
+                                        const spy::MatchConfig &settings,
+                                        const std::vector<spy::character::CharacterInformation> &characters) const {
+    nlohmann::json replay = spy::network::MessageContainer{spy::network::messages::MessageTypeEnum::REPLAY, clientId};
+    replay["sessionId"] = sessionId;
+    replay["gameStart"] = gameStart;
+    replay["gameEnd"] = gameEnd;
+    replay["playerOneId"] = playerIds.at(Player::one);
+    replay["playerTwoId"] = playerIds.at(Player::two);
+    replay["playerOneName"] = playerNames.at(Player::one);
+    replay["playerTwoName"] = playerNames.at(Player::two);
+    replay["rounds"] = rounds;
+    replay["level"] = level;
+    replay["settings"] = settings;
+    replay["characterSettings"] = characters;
+
+    // Every round is put together from its GameStatus and its state, which is patched from round to round.
+    // The rounds are serialized one after another and spliced in as the message list.
+    std::string serializedReplay = replay.dump();
+    serializedReplay.pop_back();
+    serializedReplay += R"(,"messages":[)";
+    nlohmann::json state;
+    for (auto round = recordedRounds.begin(); round != recordedRounds.end(); round++) {
+        state = state.patch(nlohmann::json::parse(round->statePatch));
+        auto message = nlohmann::json::parse(round->status);
+        message["state"] = state;
+        if (round != recordedRounds.begin()) {
+            serializedReplay += ',';
+        }
+        serializedReplay += message.dump();
+    }
+    serializedReplay += "]}";
+    return serializedReplay;
+}
+
+std::size_t MatchRecorder::memoryUsage() const {
+    std::size_t bytes = recordedRounds.capacity() * sizeof(RecordedRound) +
+                        currentOperations.capacity() * sizeof(operationList::value_type);
+    for (const auto &round : recordedRounds) {
+        bytes += round.status.capacity() + round.statePatch.capacity();
+    }
+    return bytes;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file   MatchRecorder.hpp
+ * @brief  Records the game phase of a match to answer replay requests.
+ */
+
+#ifndef SERVER017_MATCH_RECORDER_HPP
+#define SERVER017_MATCH_RECORDER_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <network/messages/GameStatus.hpp>
+#include <datatypes/matchconfig/MatchConfig.hpp>
+#include <datatypes/scenario/Scenario.hpp>
+#include <datatypes/character/CharacterInformation.hpp>
+#include <util/UUID.hpp>
+#include "Clock.hpp"
+#include "Player.hpp"
+
+/**
+ * Records the operations of a match round by round. Operations are collected until the round ends, then the
+ * round is stored as a single serialized GameStatus (spectator view of the state at the end of the round plus
+ * all operations of the round) in an append-only buffer.
+ *
+ * The state of a round can't be derived from the operations (their execution and the round initialization draw
+ * random numbers), so the state is recorded as well, but only as a JSON patch against the state of the previous
+ * round. Apart from the first state, memory use is therefore proportional to the operations and the changes they
+ * made, not to the number of rounds times the size of the map. The GameStatus messages are put together again
+ * when the Replay message is created.
+ */
+class MatchRecorder {
+    public:
+        using operationList = std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>>;
+
+        /**
+         * Discards the previous recording and starts a new one.
+         */
+        void start(const spy::util::UUID &sessionId,
+                   const std::map<Player, spy::util::UUID> &playerIds,
+                   const std::map<Player, std::string> &playerNames,
+                   Clock::time_point startTime);
+
+        /**
+         * Adds operations executed since the last broadcast to the current round.
+         */
+        void addOperations(const operationList &operations);
+
+        /**
+         * Stores the current round.
+         * @param state State at the end of the round, the known safe combinations are not recorded
+         */
+        void finishRound(const spy::util::UUID &activeCharacter, const spy::gameplay::State &state);
+
+        /**
+         * Stores the last round and completes the recording. If the game phase was never reached, the recording
+         * is discarded.
+         */
+        void finish(const spy::gameplay::State &state, Clock::time_point endTime);
+
+        /**
+         * @return True if a recording has been completed.
+         */
+        [[nodiscard]] bool hasReplay() const;
+
+        /**
+         * Creates the Replay message of the completed recording.
+         * @return Serialized Replay message
+         */
+        [[nodiscard]] std::string createReplay(const spy::util::UUID &clientId,
+                                               const spy::scenario::Scenario &level,
+                                               const spy::MatchConfig &settings,
+                                               const std::vector<spy::character::CharacterInformation> &characters) const;
+
+        /**
+         * @return Bytes used by the recorded rounds, without the state of the last round kept for the next patch.
+         */
+        [[nodiscard]] std::size_t memoryUsage() const;
+
+    private:
+        enum class Status {
+            empty,
+            recording,
+            finished
+        };
+
+        Status status = Status::empty;
+
+        spy::util::UUID sessionId;
+        std::map<Player, spy::util::UUID> playerIds;
+        std::map<Player, std::string> playerNames;
+        std::string gameStart;
+        std::string gameEnd;
+        unsigned int rounds = 0;
+
+        operationList currentOperations;
+
+        struct RecordedRound {
+            std::string status;     ///< Serialized GameStatus without the state
+            std::string statePatch; ///< Serialized JSON patch from the state of the previous round to this one
+        };
+
+        std::vector<RecordedRound> recordedRounds;
+
+        // State of the last recorded round, the next round is recorded as patch against it
+        nlohmann::json lastState;
+};
+
+#endif //SERVER017_MATCH_RECORDER_HPP
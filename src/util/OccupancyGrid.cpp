@@ -0,0 +1,125 @@
+/**
+ * @file   OccupancyGrid.cpp
+ * @brief  Implementation of the occupancy grid.
+ */
+
+#include "OccupancyGrid.hpp"
+
+OccupancyGrid::OccupancyGrid(std::shared_ptr<const ScenarioLayout> layout) : layout{std::move(layout)} {
+    clear();
+}
+
+void OccupancyGrid::update(const spy::gameplay::State &state) {
+    updateCount++;
+    moveOccupant(cat, state.getCatCoordinates());
+    moveOccupant(janitor, state.getJanitorCoordinates());
+
+    for (const auto &character : state.getCharacters()) {
+        auto [entry, inserted] = characterOccupants.emplace(character.getCharacterId(),
+                                                            static_cast<uint32_t>(occupants.size()));
+        if (inserted) {
+            occupants.push_back(Occupant{character.getCharacterId(), std::nullopt});
+        }
+        occupants[entry->second].lastUpdate = updateCount;
+        moveOccupant(entry->second, character.getCoordinates());
+    }
+
+    // Characters that were removed from the state, e.g. the NPCs once the janitor appears
+    for (uint32_t occupant = janitor + 1; occupant < occupants.size(); occupant++) {
+        if (occupants[occupant].lastUpdate != updateCount) {
+            moveOccupant(occupant, std::nullopt);
+        }
+    }
+}
+
+void OccupancyGrid::clear() {
+    occupants.assign(2, Occupant{});
+    characterOccupants.clear();
+
+    auto fieldCount = static_cast<std::size_t>(layout->getWidth()) * layout->getHeight();
+    occupantOfField.assign(fieldCount, none);
+    freeIndexOfField.assign(fieldCount, none);
+    freeFields = layout->getAccessibleFields();
+    for (std::size_t i = 0; i < freeFields.size(); i++) {
+        freeIndexOfField[fieldIndex(freeFields[i]).value()] = static_cast<uint32_t>(i);
+    }
+}
+
+std::optional<spy::util::UUID> OccupancyGrid::characterAt(const spy::util::Point &point) const {
+    auto field = fieldIndex(point);
+    if (not field.has_value()) {
+        return std::nullopt;
+    }
+    auto occupant = occupantOfField[field.value()];
+    if (occupant == none or occupant == cat or occupant == janitor) {
+        return std::nullopt;
+    }
+    return occupants[occupant].characterId;
+}
+
+bool OccupancyGrid::isFree(const spy::util::Point &point) const {
+    auto field = fieldIndex(point);
+    return field.has_value() and freeIndexOfField[field.value()] != none;
+}
+
+std::size_t OccupancyGrid::freeFieldCount() const {
+    return freeFields.size();
+}
+
+std::optional<std::size_t> OccupancyGrid::fieldIndex(const spy::util::Point &point) const {
+    if (point.x < 0 or point.y < 0 or static_cast<unsigned int>(point.x) >= layout->getWidth()
+        or static_cast<unsigned int>(point.y) >= layout->getHeight()) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(point.y) * layout->getWidth() + static_cast<std::size_t>(point.x);
+}
+
+void OccupancyGrid::moveOccupant(uint32_t occupant, const std::optional<spy::util::Point> &position) {
+    auto &entry = occupants[occupant];
+    if (entry.position == position) {
+        return;
+    }
+
+    if (entry.position.has_value()) {
+        auto field = fieldIndex(entry.position.value());
+        // If two occupants swapped their fields, the other one may already have taken over the field
+        if (field.has_value() and occupantOfField[field.value()] == occupant) {
+            vacate(field.value());
+        }
+    }
+
+    entry.position = position;
+    if (position.has_value()) {
+        auto field = fieldIndex(position.value());
+        if (field.has_value()) {
+            occupy(field.value(), occupant);
+        }
+    }
+}
+
+void OccupancyGrid::occupy(std::size_t field, uint32_t occupant) {
+    occupantOfField[field] = occupant;
+
+    auto freeIndex = freeIndexOfField[field];
+    if (freeIndex == none) {
+        return;
+    }
+    // Remove the field from the free fields by moving the last free field into its slot
+    auto last = freeFields.back();
+    freeFields[freeIndex] = last;
+    freeIndexOfField[fieldIndex(last).value()] = freeIndex;
+    freeFields.pop_back();
+    freeIndexOfField[field] = none;
+}
+
+void OccupancyGrid::vacate(std::size_t field) {
+    occupantOfField[field] = none;
+
+    spy::util::Point point{static_cast<int>(field % layout->getWidth()),
+                           static_cast<int>(field / layout->getWidth())};
+    auto state = layout->fieldState(point);
+    if (state == spy::scenario::FieldStateEnum::FREE or state == spy::scenario::FieldStateEnum::BAR_SEAT) {
+        freeIndexOfField[field] = static_cast<uint32_t>(freeFields.size());
+        freeFields.push_back(point);
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ * @file   OccupancyGrid.hpp
+ * @brief  Occupants of the fields of a game, with constant time lookups.
+ */
+
+#ifndef SERVER017_OCCUPANCY_GRID_HPP
+#define SERVER017_OCCUPANCY_GRID_HPP
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+#include <datatypes/gameplay/State.hpp>
+#include <util/UUID.hpp>
+#include "ScenarioLayout.hpp"
+
+/**
+ * Knows which character, the white cat or the janitor stands on every field of the scenario and which
+ * accessible fields (FREE and BAR_SEAT) nobody stands on. The occupant of a field and a random free field are
+ * looked up in constant time, instead of searching the character set and the map.
+ *
+ * The grid does not observe the state, it has to be updated after every change of the positions. An update
+ * only compares the positions of the characters, the cat and the janitor with the last update, so it does not
+ * depend on the size of the map.
+ */
+class OccupancyGrid {
+    public:
+        explicit OccupancyGrid(std::shared_ptr<const ScenarioLayout> layout);
+
+        /**
+         * Takes over the positions of the characters, the cat and the janitor from the state. Characters
+         * removed from the state or without coordinates free their field.
+         */
+        void update(const spy::gameplay::State &state);
+
+        /**
+         * Frees all fields, e.g. before the next game.
+         */
+        void clear();
+
+        /**
+         * @return Character standing on the field, nothing for the cat, the janitor or an empty field
+         */
+        [[nodiscard]] std::optional<spy::util::UUID> characterAt(const spy::util::Point &point) const;
+
+        /**
+         * @return True if the field is accessible and neither a character, the cat nor the janitor stands on it
+         */
+        [[nodiscard]] bool isFree(const spy::util::Point &point) const;
+
+        [[nodiscard]] std::size_t freeFieldCount() const;
+
+        /**
+         * @return Uniformly chosen free field, nothing if all fields are occupied
+         */
+        template<typename RandomEngine>
+        std::optional<spy::util::Point> randomFreeField(RandomEngine &rng) const {
+            if (freeFields.empty()) {
+                return std::nullopt;
+            }
+            std::uniform_int_distribution<std::size_t> randomIndex{0, freeFields.size() - 1};
+            return freeFields[randomIndex(rng)];
+        }
+
+    private:
+        static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t cat = 0;        //!< Occupant index of the white cat
+        static constexpr uint32_t janitor = 1;    //!< Occupant index of the janitor
+
+        struct Occupant {
+            spy::util::UUID characterId;            //!< Unset for the cat and the janitor
+            std::optional<spy::util::Point> position;
+            unsigned long lastUpdate = 0;
+        };
+
+        std::shared_ptr<const ScenarioLayout> layout;
+        std::vector<Occupant> occupants;
+        std::map<spy::util::UUID, uint32_t> characterOccupants;
+        unsigned long updateCount = 0;
+
+        std::vector<uint32_t> occupantOfField;  //!< Row-major, index into occupants or none
+        std::vector<uint32_t> freeIndexOfField; //!< Row-major, index into freeFields or none
+        std::vector<spy::util::Point> freeFields;
+
+        [[nodiscard]] std::optional<std::size_t> fieldIndex(const spy::util::Point &point) const;
+
+        void moveOccupant(uint32_t occupant, const std::optional<spy::util::Point> &position);
+
+        void occupy(std::size_t field, uint32_t occupant);
+
+        void vacate(std::size_t field);
+};
+
+#endif //SERVER017_OCCUPANCY_GRID_HPP
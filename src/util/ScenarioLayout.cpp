@@ -0,0 +1,93 @@
+/**
+ * @file   ScenarioLayout.cpp
+ * @brief  Implementation of the shared scenario layout.
+ */
+
+#include "ScenarioLayout.hpp"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+ScenarioLayout::ScenarioLayout(const spy::scenario::Scenario &scenario) : pristineMap{scenario} {
+    using spy::scenario::FieldStateEnum;
+
+    // Rows may differ in length, shorter rows are padded with walls
+    auto rows = nlohmann::json(scenario).at("scenario").get<std::vector<std::vector<FieldStateEnum>>>();
+    height = static_cast<unsigned int>(rows.size());
+    for (const auto &row : rows) {
+        width = std::max(width, static_cast<unsigned int>(row.size()));
+    }
+
+    fieldStates.assign(static_cast<std::size_t>(width) * height, FieldStateEnum::WALL);
+    for (unsigned int y = 0; y < height; y++) {
+        const auto &row = rows.at(y);
+        for (unsigned int x = 0; x < row.size(); x++) {
+            auto state = row.at(x);
+            fieldStates.at(static_cast<std::size_t>(y) * width + x) = state;
+
+            spy::util::Point point{static_cast<int>(x), static_cast<int>(y)};
+            switch (state) {
+                case FieldStateEnum::FREE:
+                case FieldStateEnum::BAR_SEAT:
+                    accessibleFields.push_back(point);
+                    break;
+                case FieldStateEnum::ROULETTE_TABLE:
+                    rouletteTables.push_back(point);
+                    break;
+                case FieldStateEnum::SAFE:
+                    safes.push_back(point);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+std::shared_ptr<const ScenarioLayout> ScenarioLayout::shared(const spy::scenario::Scenario &scenario) {
+    static std::mutex layoutsMutex;
+    static std::map<std::string, std::weak_ptr<const ScenarioLayout>> layouts;
+
+    auto key = nlohmann::json(scenario).dump();
+    std::lock_guard<std::mutex> lock{layoutsMutex};
+    auto &layout = layouts[key];
+    if (auto existing = layout.lock()) {
+        return existing;
+    }
+    auto created = std::make_shared<const ScenarioLayout>(scenario);
+    layout = created;
+    return created;
+}
+
+unsigned int ScenarioLayout::getWidth() const {
+    return width;
+}
+
+unsigned int ScenarioLayout::getHeight() const {
+    return height;
+}
+
+spy::scenario::FieldStateEnum ScenarioLayout::fieldState(const spy::util::Point &point) const {
+    if (point.x < 0 or point.y < 0 or static_cast<unsigned int>(point.x) >= width
+        or static_cast<unsigned int>(point.y) >= height) {
+        return spy::scenario::FieldStateEnum::WALL;
+    }
+    return fieldStates[static_cast<std::size_t>(point.y) * width + static_cast<std::size_t>(point.x)];
+}
+
+const std::vector<spy::util::Point> &ScenarioLayout::getAccessibleFields() const {
+    return accessibleFields;
+}
+
+const std::vector<spy::util::Point> &ScenarioLayout::getRouletteTables() const {
+    return rouletteTables;
+}
+
+const std::vector<spy::util::Point> &ScenarioLayout::getSafes() const {
+    return safes;
+}
+
+spy::scenario::FieldMap ScenarioLayout::createMap() const {
+    return pristineMap;
+}
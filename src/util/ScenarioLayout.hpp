@@ -0,0 +1,66 @@
+/**
+ * @file   ScenarioLayout.hpp
+ * @brief  Static layout of a scenario, shared by all games played on it.
+ */
+
+#ifndef SERVER017_SCENARIO_LAYOUT_HPP
+#define SERVER017_SCENARIO_LAYOUT_HPP
+
+#include <memory>
+#include <vector>
+#include <datatypes/scenario/Scenario.hpp>
+#include <datatypes/scenario/FieldMap.hpp>
+#include <util/Point.hpp>
+
+/**
+ * The parts of a scenario that never change during a game: the field states and the positions of the fields
+ * the game logic looks up by kind. Field states are stored row-major in one contiguous array, positions in one
+ * array per kind.
+ *
+ * The layout also holds a pristine FieldMap of the scenario (no chips, safe indices, gadgets or fog). New games
+ * copy it instead of building their map from the scenario again.
+ */
+class ScenarioLayout {
+    public:
+        explicit ScenarioLayout(const spy::scenario::Scenario &scenario);
+
+        /**
+         * Returns the layout of the scenario, layouts of equal scenarios are created only once per process and
+         * shared as long as they are used, e.g. by several servers in one process.
+         */
+        static std::shared_ptr<const ScenarioLayout> shared(const spy::scenario::Scenario &scenario);
+
+        [[nodiscard]] unsigned int getWidth() const;
+
+        [[nodiscard]] unsigned int getHeight() const;
+
+        /**
+         * @return State of the field, WALL for points outside of the scenario
+         */
+        [[nodiscard]] spy::scenario::FieldStateEnum fieldState(const spy::util::Point &point) const;
+
+        /**
+         * Fields a character can be placed on (FREE and BAR_SEAT).
+         */
+        [[nodiscard]] const std::vector<spy::util::Point> &getAccessibleFields() const;
+
+        [[nodiscard]] const std::vector<spy::util::Point> &getRouletteTables() const;
+
+        [[nodiscard]] const std::vector<spy::util::Point> &getSafes() const;
+
+        /**
+         * @return Copy of the pristine map, to be used as map of a new game
+         */
+        [[nodiscard]] spy::scenario::FieldMap createMap() const;
+
+    private:
+        unsigned int width = 0;
+        unsigned int height = 0;
+        std::vector<spy::scenario::FieldStateEnum> fieldStates;
+        std::vector<spy::util::Point> accessibleFields;
+        std::vector<spy::util::Point> rouletteTables;
+        std::vector<spy::util::Point> safes;
+        spy::scenario::FieldMap pristineMap;
+};
+
+#endif //SERVER017_SCENARIO_LAYOUT_HPP
@@ -0,0 +1,134 @@
+/**
+ * @file   SnapshotLog.cpp
+ * @brief  Implementation of the snapshot file.
+ */
+
+#include "SnapshotLog.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <spdlog/spdlog.h>
+
+namespace {
+    constexpr int openFlags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC;
+
+    /**
+     * Writes the whole line and waits until it is on disk.
+     * @return False if writing or syncing failed, errno is set
+     */
+    bool writeSynced(int fd, const std::string &line) {
+        std::size_t written = 0;
+        while (written < line.size()) {
+            auto result = ::write(fd, line.data() + written, line.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            written += static_cast<std::size_t>(result);
+        }
+        return ::fdatasync(fd) == 0;
+    }
+
+    /**
+     * Syncs the directory containing the file, so a rename in it is on disk.
+     */
+    void syncDirectory(const std::string &path) {
+        auto separator = path.find_last_of('/');
+        std::string directory = separator == std::string::npos ? "." : path.substr(0, separator + 1);
+        int dirFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd < 0 or ::fsync(dirFd) != 0) {
+            spdlog::warn("Syncing the directory of the snapshot file failed: {}", std::strerror(errno));
+        }
+        if (dirFd >= 0) {
+            ::close(dirFd);
+        }
+    }
+}
+
+SnapshotLog::SnapshotLog(std::string path) : path{std::move(path)} {
+    fd = ::open(this->path.c_str(), openFlags, 0644);
+    if (fd < 0) {
+        throw std::runtime_error{"Could not open snapshot file " + this->path + ": " + std::strerror(errno)};
+    }
+}
+
+SnapshotLog::~SnapshotLog() {
+    ::close(fd);
+}
+
+void SnapshotLog::append(const nlohmann::json &entry) {
+    std::string line = entry.dump();
+    line.push_back('\n');
+
+    // The file is opened for appending, so its end is where the entry starts
+    auto offset = ::lseek(fd, 0, SEEK_END);
+    if (not writeSynced(fd, line)) {
+        spdlog::error("Writing snapshot entry failed: {}", std::strerror(errno));
+        // readSession stops at the first incomplete line, thus a partially written entry is removed
+        if (offset < 0 or ::ftruncate(fd, offset) != 0) {
+            spdlog::error("Removing incomplete snapshot entry failed: {}", std::strerror(errno));
+        }
+    }
+}
+
+void SnapshotLog::compact(const nlohmann::json &checkpoint) {
+    std::string line = checkpoint.dump();
+    line.push_back('\n');
+
+    auto tempPath = path + ".tmp";
+    int tempFd = ::open(tempPath.c_str(), openFlags | O_TRUNC, 0644);
+    if (tempFd < 0 or not writeSynced(tempFd, line) or ::rename(tempPath.c_str(), path.c_str()) != 0) {
+        spdlog::error("Replacing snapshot file failed, appending the checkpoint instead: {}", std::strerror(errno));
+        if (tempFd >= 0) {
+            ::close(tempFd);
+            ::unlink(tempPath.c_str());
+        }
+        append(checkpoint);
+        return;
+    }
+
+    syncDirectory(path);
+    ::close(fd);
+    fd = tempFd;
+}
+
+void SnapshotLog::clear() {
+    if (::ftruncate(fd, 0) != 0 or ::fdatasync(fd) != 0) {
+        spdlog::error("Clearing snapshot file failed: {}", std::strerror(errno));
+    }
+}
+
+std::optional<nlohmann::json> SnapshotLog::readSession(const std::string &path) {
+    std::ifstream file{path};
+    std::optional<nlohmann::json> session;
+    std::string line;
+
+    while (std::getline(file, line)) {
+        nlohmann::json entry;
+        try {
+            entry = nlohmann::json::parse(line);
+        } catch (const nlohmann::json::exception &e) {
+            spdlog::warn("Ignoring incomplete snapshot entry: {}", e.what());
+            break;
+        }
+
+        auto type = entry.value("entry", "");
+        if (type == checkpointEntry) {
+            session = std::move(entry);
+        } else if (type == operationEntry and session.has_value()) {
+            for (const auto &[key, value] : entry.items()) {
+                session.value()[key] = value;
+            }
+        }
+    }
+
+    if (session.has_value()) {
+        session.value()["entry"] = checkpointEntry;
+    }
+    return session;
+}
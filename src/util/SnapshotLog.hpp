@@ -0,0 +1,69 @@
+/**
+ * @file   SnapshotLog.hpp
+ * @brief  File of the last session checkpoint and the following operation entries, used to resume a match after
+ *         a crash.
+ */
+
+#ifndef SERVER017_SNAPSHOT_LOG_HPP
+#define SERVER017_SNAPSHOT_LOG_HPP
+
+#include <optional>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * Writes one JSON object per line and syncs the file after every entry, so an entry is on disk before the
+ * clients are informed about the change it describes.
+ * There are two kinds of entries: checkpoints contain the whole session and are written at the start of every
+ * round, operation entries contain the parts of the session that change with every operation. A checkpoint
+ * replaces the file, thus it holds at most the entries of one round.
+ */
+class SnapshotLog {
+    public:
+        static constexpr auto checkpointEntry = "checkpoint";
+        static constexpr auto operationEntry = "operation";
+
+        /**
+         * Opens the file for appending, creates it if necessary.
+         * @throws std::runtime_error if the file can not be opened
+         */
+        explicit SnapshotLog(std::string path);
+
+        SnapshotLog(const SnapshotLog &other) = delete;
+
+        SnapshotLog &operator=(const SnapshotLog &other) = delete;
+
+        ~SnapshotLog();
+
+        /**
+         * Appends an entry and waits until it is written to disk. If writing fails, the file is truncated to its
+         * previous size, so no incomplete entry hides the entries appended later.
+         * @param entry Object with the key "entry" set to checkpointEntry or operationEntry
+         */
+        void append(const nlohmann::json &entry);
+
+        /**
+         * Replaces all entries by a checkpoint. The checkpoint is written to a temporary file which is renamed
+         * over the file once it is on disk, so a crash leaves either the old entries or the checkpoint.
+         * @param checkpoint Object with the key "entry" set to checkpointEntry
+         */
+        void compact(const nlohmann::json &checkpoint);
+
+        /**
+         * Removes all entries, e.g. when a session ended or a new one started.
+         */
+        void clear();
+
+        /**
+         * Reads the last session from a file: the last checkpoint with all following operation entries applied.
+         * An incomplete last line (crash while writing) is ignored.
+         * @return The session or nothing if the file doesn't exist or contains no checkpoint
+         */
+        static std::optional<nlohmann::json> readSession(const std::string &path);
+
+    private:
+        std::string path;
+        int fd;
+};
+
+#endif //SERVER017_SNAPSHOT_LOG_HPP
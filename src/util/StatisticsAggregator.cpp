@@ -0,0 +1,155 @@
+/**
+ * @file   StatisticsAggregator.cpp
+ * @brief  Implementation of the statistics aggregator.
+ */
+
+#include "StatisticsAggregator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <set>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace {
+    long long milliseconds(Clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+}
+
+void StatisticsAggregator::operationExecuted(Player player, Operations::const_iterator executed,
+                                             Operations::const_iterator end, int intelligencePointsGained) {
+    using spy::gameplay::OperationEnum;
+
+    if (executed == end) {
+        return;
+    }
+    auto &playerCounters = of(player);
+    auto type = (*executed)->getType();
+    playerCounters.operations[type]++;
+    playerCounters.intelligencePoints[type] += intelligencePointsGained;
+    if (type == OperationEnum::GADGET_ACTION) {
+        playerCounters.gadgetUses++;
+    } else if (type == OperationEnum::MOVEMENT) {
+        playerCounters.moves++;
+    }
+
+    for (auto consequence = std::next(executed); consequence != end; consequence++) {
+        if ((*consequence)->getType() == OperationEnum::EXFILTRATION) {
+            playerCounters.exfiltrations++;
+        }
+    }
+}
+
+void StatisticsAggregator::operationRequested(Player player, Clock::time_point time) {
+    auto &playerCounters = of(player);
+    playerCounters.waitingForOperation = true;
+    playerCounters.currentThinkTime = Clock::duration::zero();
+    playerCounters.thinkingSince = time;
+}
+
+void StatisticsAggregator::turnFinished(Player player, Clock::time_point time) {
+    auto &playerCounters = of(player);
+    if (not playerCounters.waitingForOperation) {
+        return;
+    }
+    auto thinkTime = playerCounters.currentThinkTime;
+    if (playerCounters.thinkingSince.has_value()) {
+        thinkTime += time - playerCounters.thinkingSince.value();
+    }
+    playerCounters.waitingForOperation = false;
+    playerCounters.thinkingSince.reset();
+    playerCounters.turns++;
+    playerCounters.thinkTime += thinkTime;
+    playerCounters.longestThinkTime = std::max(playerCounters.longestThinkTime, thinkTime);
+}
+
+void StatisticsAggregator::gamePaused(Clock::time_point time) {
+    for (auto &playerCounters : counters) {
+        if (playerCounters.thinkingSince.has_value()) {
+            playerCounters.currentThinkTime += time - playerCounters.thinkingSince.value();
+            playerCounters.thinkingSince.reset();
+        }
+    }
+}
+
+void StatisticsAggregator::gameResumed(Clock::time_point time) {
+    for (auto &playerCounters : counters) {
+        if (playerCounters.waitingForOperation and not playerCounters.thinkingSince.has_value()) {
+            playerCounters.thinkingSince = time;
+        }
+    }
+}
+
+void StatisticsAggregator::strikeIssued(Player player) {
+    of(player).strikes++;
+}
+
+void StatisticsAggregator::pauseRequested(Player player) {
+    of(player).pauses++;
+}
+
+void StatisticsAggregator::reconnected(Player player) {
+    of(player).reconnects++;
+}
+
+void StatisticsAggregator::addEntries(spy::statistics::Statistics &statistics) const {
+    using spy::statistics::StatisticsEntry;
+
+    const auto &one = counters[static_cast<std::size_t>(Player::one)];
+    const auto &two = counters[static_cast<std::size_t>(Player::two)];
+    auto addEntry = [&statistics](const std::string &title, const std::string &description, auto valueOne,
+                                  auto valueTwo) {
+        statistics.addEntry(StatisticsEntry{title, description, std::to_string(valueOne), std::to_string(valueTwo)});
+    };
+
+    unsigned int operationsOne = 0;
+    unsigned int operationsTwo = 0;
+    std::set<spy::gameplay::OperationEnum> types;
+    for (const auto &[type, count] : one.operations) {
+        operationsOne += count;
+        types.insert(type);
+    }
+    for (const auto &[type, count] : two.operations) {
+        operationsTwo += count;
+        types.insert(type);
+    }
+
+    addEntry("Operations", "Number of operations the players made", operationsOne, operationsTwo);
+    addEntry("Moves", "Number of movements of the characters of the players", one.moves, two.moves);
+    addEntry("Gadget uses", "Number of gadget actions of the characters of the players", one.gadgetUses,
+             two.gadgetUses);
+    for (const auto &type : types) {
+        auto typeName = nlohmann::json(type).get<std::string>();
+        auto intelligencePoints = [&type](const PlayerCounters &playerCounters) {
+            auto points = playerCounters.intelligencePoints.find(type);
+            return points == playerCounters.intelligencePoints.end() ? 0 : points->second;
+        };
+        addEntry("IP by " + typeName, "Intelligence points the players gained with operations of type " + typeName,
+                 intelligencePoints(one), intelligencePoints(two));
+    }
+    addEntry("Exfiltrations", "Number of exfiltrations caused by operations of the players", one.exfiltrations,
+             two.exfiltrations);
+
+    auto averageThinkTime = [](const PlayerCounters &playerCounters) {
+        return playerCounters.turns == 0 ? Clock::duration::zero() : playerCounters.thinkTime / playerCounters.turns;
+    };
+    addEntry("Think time", "Time the players took for their turns in milliseconds", milliseconds(one.thinkTime),
+             milliseconds(two.thinkTime));
+    addEntry("Average think time", "Average time the players took for a turn in milliseconds",
+             milliseconds(averageThinkTime(one)), milliseconds(averageThinkTime(two)));
+    addEntry("Longest think time", "Longest time a player took for a turn in milliseconds",
+             milliseconds(one.longestThinkTime), milliseconds(two.longestThinkTime));
+
+    addEntry("Strikes", "Number of strikes the players received", one.strikes, two.strikes);
+    addEntry("Pauses", "Number of pauses the players requested", one.pauses, two.pauses);
+    addEntry("Reconnects", "Number of reconnects of the players", one.reconnects, two.reconnects);
+}
+
+void StatisticsAggregator::reset() {
+    counters = {};
+}
+
+auto StatisticsAggregator::of(Player player) -> PlayerCounters & {
+    return counters.at(static_cast<std::size_t>(player));
+}
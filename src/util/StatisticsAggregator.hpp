@@ -0,0 +1,96 @@
+/**
+ * @file   StatisticsAggregator.hpp
+ * @brief  Statistics of both players, collected while the game is played.
+ */
+
+#ifndef SERVER017_STATISTICS_AGGREGATOR_HPP
+#define SERVER017_STATISTICS_AGGREGATOR_HPP
+
+#include <array>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <datatypes/gameplay/BaseOperation.hpp>
+#include <network/messages/StatisticsMessage.hpp>
+#include "Clock.hpp"
+#include "Player.hpp"
+
+/**
+ * Counts what the players did during a game as it happens: operations by type, gadget uses, moves,
+ * intelligence points gained by operation type, exfiltrations, think time, strikes, pauses and reconnects.
+ * The statistics of the game are created from the counters, without looking at the game state or the
+ * operations again. The counters do not grow with the length of the game.
+ */
+class StatisticsAggregator {
+    public:
+        using Operations = std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>>;
+
+        /**
+         * @param executed                 Executed operation of the player followed by its consequences
+         * @param end                      End of the consequences
+         * @param intelligencePointsGained Change of the intelligence points of the acting character
+         */
+        void operationExecuted(Player player, Operations::const_iterator executed, Operations::const_iterator end,
+                               int intelligencePointsGained);
+
+        /**
+         * The server requested an operation from the player, the think time of the player starts.
+         */
+        void operationRequested(Player player, Clock::time_point time);
+
+        /**
+         * The player sent an operation or the turn phase limit was reached, the think time of the player ends.
+         */
+        void turnFinished(Player player, Clock::time_point time);
+
+        /**
+         * The game was paused, the think time of a player waiting for an operation request stops.
+         */
+        void gamePaused(Clock::time_point time);
+
+        /**
+         * The game continues, the think time of a player waiting for an operation request continues as well.
+         */
+        void gameResumed(Clock::time_point time);
+
+        void strikeIssued(Player player);
+
+        void pauseRequested(Player player);
+
+        void reconnected(Player player);
+
+        /**
+         * Adds one entry per statistic, with the values of player one and two.
+         */
+        void addEntries(spy::statistics::Statistics &statistics) const;
+
+        /**
+         * Clears all counters for the next game.
+         */
+        void reset();
+
+    private:
+        struct PlayerCounters {
+            std::map<spy::gameplay::OperationEnum, unsigned int> operations;
+            std::map<spy::gameplay::OperationEnum, int> intelligencePoints;
+            unsigned int gadgetUses = 0;
+            unsigned int moves = 0;
+            unsigned int exfiltrations = 0;
+            unsigned int turns = 0;
+            Clock::duration thinkTime = Clock::duration::zero();
+            Clock::duration longestThinkTime = Clock::duration::zero();
+            bool waitingForOperation = false;
+            Clock::duration currentThinkTime = Clock::duration::zero();     ///< Of the requested operation
+            std::optional<Clock::time_point> thinkingSince;                 ///< Not set while the game is paused
+            unsigned int strikes = 0;
+            unsigned int pauses = 0;
+            unsigned int reconnects = 0;
+        };
+
+        std::array<PlayerCounters, 2> counters;
+
+        PlayerCounters &of(Player player);
+};
+
+#endif //SERVER017_STATISTICS_AGGREGATOR_HPP
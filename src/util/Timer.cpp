@@ -2,7 +2,7 @@
  * @file Timer.cpp
  * @author jonas
  * @date 6/4/20
- * Simple timer using threads
+ * Simple timer on top of a Clock
  */
 
 #include "Timer.hpp"
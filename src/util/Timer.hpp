@@ -2,7 +2,7 @@
  * @file Timer.hpp
  * @author jonas
  * @date 01.06.20
- * Simple timer using threads
+ * Simple timer on top of a Clock
  */
 
 #ifndef SERVER017_TIMER_HPP
@@ -12,6 +12,7 @@
 #include <thread>
 #include <iostream>
 #include <optional>
+#include "Clock.hpp"
 
 /**
  * Implements a timer that defers a function call for a specified time. Timer will stop on object destruction.
@@ -19,7 +20,7 @@
 class Timer {
     public:
 
-        using optionalTimePoint = std::optional<std::chrono::time_point<std::chrono::system_clock>>;
+        using optionalTimePoint = std::optional<Clock::time_point>;
 
         /**
          * Creates a stopped timer
@@ -38,33 +39,37 @@ class Timer {
 
         /**
          * Restarts the timer to execute a function after the specified timeout
+         * @param clock Clock measuring the timeout
          * @param timeout Timer duration
          * @param function Function to execute after timeout
          * @param args Arguments to function
          * @details If the timer is running already, this will stop the old and create a new timer
          */
         template<typename FunctionType, typename Rep, typename Period, typename ...Args>
-        void restart(std::chrono::duration<Rep, Period> timeout, FunctionType function, Args &&... args) {
-            // Stop old thread
+        void restart(Clock &clock, std::chrono::duration<Rep, Period> timeout, FunctionType function,
+                     Args &&... args) {
+            // Stop old timer
             stop();
-            // Create new status variable for new thread
+            // Create new status variable for new timer
             stopped = std::make_shared<bool>(false);
-            startTime = std::chrono::system_clock::now();
-            std::thread timerThread{[stopped = this->stopped, timeout, function, args...]() {
-                std::this_thread::sleep_for(timeout);
-                if (*stopped) {
-                    return;
-                } else {
-                    function(std::forward<Args>(args)...);
-                    *stopped = true;
-                }
-            }};
-            timerThread.detach();
+            startTime = clock.now();
+
+            // Timeouts beyond the range of the clock (e.g. unlimited reconnect time) are clamped
+            Clock::duration clockTimeout = Clock::duration::max();
+            if (timeout < std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(Clock::duration::max())) {
+                clockTimeout = std::chrono::duration_cast<Clock::duration>(timeout);
+            }
+
+            clock.schedule(clockTimeout, stopped, [stopped = this->stopped, function, args...]() {
+                function(args...);
+                *stopped = true;
+            });
         }
 
         /**
          * @brief Stops the timer.
-         * @details Timer thread will not terminate immediately, but will not execute function after time is up.
+         * @details With the SystemClock the timer thread will not terminate immediately, but will not execute the
+         *          function after time is up.
          */
         void stop();
 
@@ -8,6 +8,7 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/ostr.h>
 #include <network/MessageRouter.hpp>
+#include <util/RoundUtils.hpp>
 #include "Util.hpp"
 
 auto Util::getFactionGadgets(const spy::character::CharacterSet &characters,
@@ -70,3 +71,21 @@ bool Util::hasMPInFog(const spy::character::Character &character, const spy::gam
         return !state.getMap().getField(character.getCoordinates().value()).isFoggy();
     }
 }
+
+void Util::initRound(spy::gameplay::State &state, const spy::MatchConfig &matchConfig,
+                     std::deque<spy::util::UUID> &roundOrder) {
+    using spy::util::RoundUtils;
+
+    // Field level updates, none of them moves a character
+    RoundUtils::refillBarTables(state);
+    RoundUtils::updateFog(state);
+    RoundUtils::checkGadgetFailure(state, matchConfig);
+    RoundUtils::resetUpdatedMarker(state);
+
+    for (auto &character: state.getCharacters()) {
+        if (character.getCoordinates().has_value()) {
+            roundOrder.push_back(character.getCharacterId());
+        }
+        RoundUtils::determinePoints(character);
+    }
+}
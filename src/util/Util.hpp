@@ -13,11 +13,12 @@
 #include <network/messages/MetaInformationKey.hpp>
 #include <network/messages/MetaInformation.hpp>
 #include <datatypes/gameplay/State.hpp>
+#include <datatypes/matchconfig/MatchConfig.hpp>
+#include <deque>
 #include <spdlog/spdlog.h>
 #include "Player.hpp"
 #include "Format.hpp"
 #include "network/MessageRouter.hpp"
-#include "network/MessageTypeTraits.hpp"
 
 class Util {
         using MetaInformationKey = spy::network::messages::MetaInformationKey;
@@ -49,6 +50,17 @@ class Util {
          */
         static bool hasMPInFog(const spy::character::Character &character, const spy::gameplay::State &state);
 
+        /**
+         * Updates the state at the beginning of a round: bar tables, fog, gadget failures and updated markers of
+         * the fields, then action and move points of all characters. The characters are visited in a single
+         * pass, which also appends the characters on the map to the round order.
+         * @param state       Current game state.
+         * @param matchConfig Configuration of the match.
+         * @param roundOrder  Round order the characters on the map are appended to.
+         */
+        static void initRound(spy::gameplay::State &state, const spy::MatchConfig &matchConfig,
+                              std::deque<spy::util::UUID> &roundOrder);
+
         /**
          *
          * @tparam FSM Type of the used state machine.
@@ -143,28 +155,6 @@ class Util {
                                          const std::map<Player, spy::util::UUID> &playerIds,
                                          const MessageRouter &router);
 
-
-        /**
-         * Checks if a client with the given role is allowed to send the given message type.
-         * @tparam MessageType Type of the message.
-         * @param clientRole   Current role of the client.
-         * @param msg          Message.
-         * @return True if the client is allowed to send the message, else false.
-         */
-        template<typename MessageType>
-        static bool isAllowedMessage(spy::network::RoleEnum clientRole, MessageType msg) {
-            switch (clientRole) {
-                case spy::network::RoleEnum::PLAYER:
-                    return receivableFromPlayer<decltype(msg)>::value;
-                case spy::network::RoleEnum::SPECTATOR:
-                    return receivableFromSpectator<decltype(msg)>::value;
-                case spy::network::RoleEnum::AI:
-                    return receivableFromAI<decltype(msg)>::value;
-                default:
-                    return false;
-            }
-        }
-
         static Player opponentOf(Player p) {
             switch (p) {
                 case Player::one:
@@ -0,0 +1,60 @@
+/**
+ * @file   AllocationCounter.cpp
+ * @brief  Replacement of the global operator new counting every allocation.
+ */
+
+#include "AllocationCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<unsigned long> allocationCount = 0;
+
+    void *allocate(std::size_t size) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0) {
+            size = 1;
+        }
+        while (true) {
+            if (void *memory = std::malloc(size)) {
+                return memory;
+            }
+            auto handler = std::get_new_handler();
+            if (handler == nullptr) {
+                throw std::bad_alloc{};
+            }
+            handler();
+        }
+    }
+}
+
+namespace bench {
+    unsigned long allocations() {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+}
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
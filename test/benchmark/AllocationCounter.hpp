@@ -0,0 +1,16 @@
+/**
+ * @file   AllocationCounter.hpp
+ * @brief  Counts the heap allocations of the benchmark process.
+ */
+
+#ifndef SERVER017_BENCHMARK_ALLOCATION_COUNTER_HPP
+#define SERVER017_BENCHMARK_ALLOCATION_COUNTER_HPP
+
+namespace bench {
+    /**
+     * @return Number of calls of the global operator new (all threads) since the start of the process.
+     */
+    unsigned long allocations();
+}
+
+#endif //SERVER017_BENCHMARK_ALLOCATION_COUNTER_HPP
@@ -0,0 +1,61 @@
+/**
+ * @file   Fixtures.cpp
+ * @brief  Shared test data for the benchmarks.
+ */
+
+#include "Fixtures.hpp"
+#include <fstream>
+#include <datatypes/character/CharacterDescription.hpp>
+#include <util/GameLogicUtils.hpp>
+#include <util/RoundUtils.hpp>
+
+namespace bench {
+    static nlohmann::json loadJson(const std::string &fileName) {
+        std::ifstream ifs{std::string{SERVER017_CONFIG_DIR} + "/" + fileName};
+        return nlohmann::json::parse(ifs);
+    }
+
+    const Configs &configs() {
+        static const Configs loadedConfigs = []() {
+            Configs c;
+            c.matchConfig = loadJson("matchconfig.match").get<spy::MatchConfig>();
+            c.scenarioConfig = loadJson("scenario.scenario").get<spy::scenario::Scenario>();
+            for (const auto &characterDescriptionJson : loadJson("characters.json")) {
+                auto characterDescription = characterDescriptionJson.get<spy::character::CharacterDescription>();
+                c.characterInformations.emplace_back(std::move(characterDescription), spy::util::UUID::generate());
+            }
+            return c;
+        }();
+        return loadedConfigs;
+    }
+
+    spy::gameplay::State createState(unsigned int characterCount) {
+        using spy::character::FactionEnum;
+        using spy::util::GameLogicUtils;
+
+        const Configs &c = configs();
+        constexpr FactionEnum factions[] = {FactionEnum::PLAYER1, FactionEnum::PLAYER2, FactionEnum::NEUTRAL};
+
+        spy::gameplay::State state{0, spy::scenario::FieldMap{c.scenarioConfig}, {}, {}, std::nullopt,
+                                   std::nullopt};
+
+        spy::character::CharacterSet charSet;
+        for (unsigned int i = 0; i < characterCount and i < c.characterInformations.size(); i++) {
+            const auto &info = c.characterInformations.at(i);
+            auto character = spy::character::Character{info.getCharacterId(), info.getName()};
+            character.setProperties(
+                    std::set<spy::character::PropertyEnum>{info.getFeatures().begin(), info.getFeatures().end()});
+            character.setFaction(factions[i % 3]);
+            charSet.insert(character);
+        }
+        state.setCharacters(charSet);
+
+        for (auto &character : state.getCharacters()) {
+            character.setCoordinates(GameLogicUtils::getRandomCharacterFreeMapPoint(state).value());
+            spy::util::RoundUtils::determinePoints(character);
+        }
+        state.setCatCoordinates(GameLogicUtils::getRandomCharacterFreeMapPoint(state).value());
+
+        return state;
+    }
+}
@@ -0,0 +1,40 @@
+/**
+ * @file   Fixtures.hpp
+ * @brief  Shared test data for the benchmarks.
+ */
+
+#ifndef SERVER017_BENCHMARK_FIXTURES_HPP
+#define SERVER017_BENCHMARK_FIXTURES_HPP
+
+#include <vector>
+#include <datatypes/matchconfig/MatchConfig.hpp>
+#include <datatypes/scenario/Scenario.hpp>
+#include <datatypes/character/CharacterInformation.hpp>
+#include <datatypes/gameplay/State.hpp>
+
+namespace bench {
+    /**
+     * Configuration files of the exampleConfig directory.
+     */
+    struct Configs {
+        spy::MatchConfig matchConfig;
+        spy::scenario::Scenario scenarioConfig;
+        std::vector<spy::character::CharacterInformation> characterInformations;
+    };
+
+    /**
+     * Loads the example configuration on first use.
+     * @return Example configuration.
+     */
+    const Configs &configs();
+
+    /**
+     * Creates a game state like after the equip phase, with characters assigned round robin to both players
+     * and the NPCs and placed randomly on the map together with the white cat.
+     * @param characterCount Number of characters in the state.
+     * @return Initialized game state.
+     */
+    spy::gameplay::State createState(unsigned int characterCount = 12);
+}
+
+#endif //SERVER017_BENCHMARK_FIXTURES_HPP
@@ -0,0 +1,350 @@
+/**
+ * @file   GameLogicBenchmarks.cpp
+ * @brief  Benchmarks for the choice phase data structure, operation execution, the setup of a new game and field
+ *         lookups.
+ */
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <random>
+#include <gameLogic/generation/ActionGenerator.hpp>
+#include <util/GameLogicUtils.hpp>
+#include <util/CharacterIndex.hpp>
+#include <util/ChoiceSet.hpp>
+#include <util/RoundUtils.hpp>
+#include <util/Util.hpp>
+#include <util/Operation.hpp>
+#include <util/ScenarioLayout.hpp>
+#include <util/GameStatePool.hpp>
+#include <util/GameOverTracker.hpp>
+#include <util/OccupancyGrid.hpp>
+#include "Fixtures.hpp"
+
+namespace {
+    const std::vector<spy::gadget::GadgetEnum> gadgets = {
+            spy::gadget::GadgetEnum::HAIRDRYER,
+            spy::gadget::GadgetEnum::MOLEDIE,
+            spy::gadget::GadgetEnum::TECHNICOLOUR_PRISM,
+            spy::gadget::GadgetEnum::BOWLER_BLADE,
+            spy::gadget::GadgetEnum::MAGNETIC_WATCH,
+            spy::gadget::GadgetEnum::POISON_PILLS,
+            spy::gadget::GadgetEnum::LASER_COMPACT,
+            spy::gadget::GadgetEnum::ROCKET_PEN,
+            spy::gadget::GadgetEnum::GAS_GLOSS,
+            spy::gadget::GadgetEnum::MOTHBALL_POUCH,
+            spy::gadget::GadgetEnum::FOG_TIN,
+            spy::gadget::GadgetEnum::GRAPPLE,
+            spy::gadget::GadgetEnum::WIRETAP_WITH_EARPLUGS,
+            spy::gadget::GadgetEnum::JETPACK,
+            spy::gadget::GadgetEnum::CHICKEN_FEED,
+            spy::gadget::GadgetEnum::NUGGET,
+            spy::gadget::GadgetEnum::MIRROR_OF_WILDERNESS,
+            spy::gadget::GadgetEnum::POCKET_LITTER,
+            spy::gadget::GadgetEnum::ANTI_PLAGUE_MASK
+    };
+
+    /**
+     * Scenario of size x size fields, every tenth field of a row is a bar table, all others are free.
+     */
+    spy::scenario::Scenario squareScenario(unsigned int size) {
+        using spy::scenario::FieldStateEnum;
+        std::vector<FieldStateEnum> row(size, FieldStateEnum::FREE);
+        for (std::size_t x = 9; x < row.size(); x += 10) {
+            row.at(x) = FieldStateEnum::BAR_TABLE;
+        }
+        std::vector<std::vector<FieldStateEnum>> rows(size, row);
+        return nlohmann::json{{"scenario", rows}}.get<spy::scenario::Scenario>();
+    }
+
+    /**
+     * Game state of bench::createState on a square scenario, with an occupancy grid of the state.
+     */
+    struct OccupancyFixture {
+        std::shared_ptr<const ScenarioLayout> layout;
+        OccupancyGrid grid;
+        spy::gameplay::State gameState;
+        std::mt19937 rng{17};
+
+        explicit OccupancyFixture(unsigned int size) :
+                layout{std::make_shared<const ScenarioLayout>(squareScenario(size))},
+                grid{layout},
+                gameState{0, layout->createMap(), {}, {}, std::nullopt, std::nullopt} {
+            gameState.setCharacters(bench::createState().getCharacters());
+            grid.update(gameState);
+
+            // Move the characters from their fields on the example scenario to random fields of this one
+            for (auto &character : gameState.getCharacters()) {
+                character.setCoordinates(grid.randomFreeField(rng).value());
+                grid.update(gameState);
+            }
+            gameState.setCatCoordinates(grid.randomFreeField(rng).value());
+            grid.update(gameState);
+        }
+    };
+}
+
+/**
+ * Draws a full offer from the choice set and puts it back afterwards, like a player rejecting an offer.
+ */
+static void BM_ChoiceSetRequestSelection(benchmark::State &state) {
+    ChoiceSet choiceSet;
+    choiceSet.addForSelection(bench::configs().characterInformations, gadgets);
+
+    for (auto _ : state) {
+        auto offer = choiceSet.requestSelection();
+        benchmark::DoNotOptimize(offer);
+        choiceSet.addForSelection(offer.characters, offer.gadgets);
+    }
+}
+
+BENCHMARK(BM_ChoiceSetRequestSelection);
+
+/**
+ * Executes a generated operation of the first character. With exfiltration enabled, another character has no
+ * health points left, so the exfiltration sweep of executeOperation has to generate and execute an exfiltration.
+ */
+static void BM_ExecuteOperation(benchmark::State &state) {
+    const auto &matchConfig = bench::configs().matchConfig;
+    const auto initialState = bench::createState();
+    const bool exfiltration = state.range(0) != 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto gameState = initialState;
+        auto character = gameState.getCharacters().begin();
+        if (exfiltration) {
+            std::next(character)->setHealthPoints(0);
+        }
+
+        std::shared_ptr<const spy::gameplay::BaseOperation> operation =
+                spy::gameplay::ActionGenerator::generateNPCAction(gameState, character->getCharacterId(),
+                                                                  matchConfig);
+        if (operation == nullptr) {
+            operation = std::make_shared<spy::gameplay::RetireAction>(character->getCharacterId());
+        }
+
+        std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>> operations;
+        std::deque<spy::util::UUID> remainingCharacters;
+        for (const auto &c : gameState.getCharacters()) {
+            remainingCharacters.push_back(c.getCharacterId());
+        }
+        state.ResumeTiming();
+
+        executeOperation(operation, gameState, matchConfig, operations, remainingCharacters);
+        benchmark::DoNotOptimize(operations);
+    }
+}
+
+BENCHMARK(BM_ExecuteOperation)->ArgName("exfiltration")->Arg(0)->Arg(1);
+
+/**
+ * Creation of the map for a new game, either built from the scenario (argument 0) or copied from the pristine
+ * map of the shared ScenarioLayout (argument 1) like the server does.
+ */
+static void BM_NewGameMap(benchmark::State &state) {
+    const auto &scenario = bench::configs().scenarioConfig;
+    auto layout = ScenarioLayout::shared(scenario);
+    bool fromLayout = state.range(0) != 0;
+
+    for (auto _ : state) {
+        if (fromLayout) {
+            auto map = layout->createMap();
+            benchmark::DoNotOptimize(map);
+        } else {
+            auto map = spy::scenario::FieldMap{scenario};
+            benchmark::DoNotOptimize(map);
+        }
+    }
+}
+
+BENCHMARK(BM_NewGameMap)->ArgName("fromLayout")->Arg(0)->Arg(1);
+
+/**
+ * Takes the map and character placement of a new game from a GameStatePool, as done when entering the game
+ * phase. The argument is the capacity of the pool, with 0 every game is prepared when it is taken. The misses
+ * counter is the share of games the background thread had not prepared in time.
+ */
+static void BM_TakePreparedGame(benchmark::State &state) {
+    const auto &configs = bench::configs();
+    GameStatePool pool{ScenarioLayout::shared(configs.scenarioConfig), configs.matchConfig.getMinChipsRoulette(),
+                       configs.matchConfig.getMaxChipsRoulette(), static_cast<std::size_t>(state.range(0)), 17};
+
+    for (auto _ : state) {
+        auto game = pool.take();
+        benchmark::DoNotOptimize(game);
+
+        // a new game starts at most once per match, give the pool time to refill
+        state.PauseTiming();
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        state.ResumeTiming();
+    }
+    state.counters["misses"] = benchmark::Counter(static_cast<double>(pool.misses()),
+                                                  benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_TakePreparedGame)->ArgName("capacity")->Arg(0)->Arg(1);
+
+/**
+ * Draws a random field without character, like the placement of the janitor, either by searching the map with
+ * GameLogicUtils (second argument 0) or from the OccupancyGrid (1). The first argument is the width and height
+ * of the scenario.
+ */
+static void BM_RandomFreeField(benchmark::State &state) {
+    OccupancyFixture fixture{static_cast<unsigned int>(state.range(0))};
+    bool fromGrid = state.range(1) != 0;
+
+    for (auto _ : state) {
+        if (fromGrid) {
+            auto field = fixture.grid.randomFreeField(fixture.rng);
+            benchmark::DoNotOptimize(field);
+        } else {
+            auto field = spy::util::GameLogicUtils::getRandomCharacterFreeMapPoint(fixture.gameState);
+            benchmark::DoNotOptimize(field);
+        }
+    }
+}
+
+BENCHMARK(BM_RandomFreeField)->ArgNames({"size", "grid"})
+        ->Args({20, 0})->Args({20, 1})->Args({100, 0})->Args({100, 1})->Args({1000, 0})->Args({1000, 1});
+
+/**
+ * Looks up the character standing on a field, like the target of the janitor, either by searching the
+ * character set with GameLogicUtils (argument 0) or in the OccupancyGrid (1).
+ */
+static void BM_CharacterAt(benchmark::State &state) {
+    OccupancyFixture fixture{1000};
+    bool fromGrid = state.range(0) != 0;
+    // The character searched last
+    std::optional<spy::util::Point> target;
+    for (const auto &character : fixture.gameState.getCharacters()) {
+        target = character.getCoordinates();
+    }
+
+    for (auto _ : state) {
+        if (fromGrid) {
+            auto character = fixture.grid.characterAt(target.value());
+            benchmark::DoNotOptimize(character);
+        } else {
+            auto character = spy::util::GameLogicUtils::getInCharacterSetByCoordinates(
+                    fixture.gameState.getCharacters(), target.value());
+            benchmark::DoNotOptimize(character);
+        }
+    }
+}
+
+BENCHMARK(BM_CharacterAt)->ArgName("grid")->Arg(0)->Arg(1);
+
+/**
+ * Update of the OccupancyGrid after an operation that moved one character to a random free field. The argument
+ * is the width and height of the scenario, the update does not depend on it.
+ */
+static void BM_OccupancyUpdate(benchmark::State &state) {
+    OccupancyFixture fixture{static_cast<unsigned int>(state.range(0))};
+    auto &character = *fixture.gameState.getCharacters().begin();
+
+    for (auto _ : state) {
+        character.setCoordinates(fixture.grid.randomFreeField(fixture.rng).value());
+        fixture.grid.update(fixture.gameState);
+    }
+    if (fixture.grid.freeFieldCount() != fixture.layout->getAccessibleFields().size()
+                                         - fixture.gameState.getCharacters().size() - 1) {
+        state.SkipWithError("Free fields of the grid do not match the state");
+    }
+}
+
+BENCHMARK(BM_OccupancyUpdate)->ArgName("size")->Arg(20)->Arg(100)->Arg(1000);
+
+/**
+ * Updates of the state at the beginning of a round, either with separate passes over the characters for the
+ * round order and the points (second argument 0, like roundInit did before) or with Util::initRound (1). The
+ * first argument is the width and height of the scenario.
+ */
+static void BM_RoundInit(benchmark::State &state) {
+    using spy::util::RoundUtils;
+
+    OccupancyFixture fixture{static_cast<unsigned int>(state.range(0))};
+    const auto &matchConfig = bench::configs().matchConfig;
+    bool fused = state.range(1) != 0;
+    std::deque<spy::util::UUID> roundOrder;
+
+    for (auto _ : state) {
+        roundOrder.clear();
+        if (fused) {
+            Util::initRound(fixture.gameState, matchConfig, roundOrder);
+        } else {
+            for (const auto &character : fixture.gameState.getCharacters()) {
+                if (character.getCoordinates().has_value()) {
+                    roundOrder.push_back(character.getCharacterId());
+                }
+            }
+            RoundUtils::refillBarTables(fixture.gameState);
+            RoundUtils::updateFog(fixture.gameState);
+            RoundUtils::checkGadgetFailure(fixture.gameState, matchConfig);
+            RoundUtils::resetUpdatedMarker(fixture.gameState);
+            for (auto &character : fixture.gameState.getCharacters()) {
+                RoundUtils::determinePoints(character);
+            }
+        }
+        benchmark::DoNotOptimize(roundOrder);
+    }
+}
+
+BENCHMARK(BM_RoundInit)->ArgNames({"size", "fused"})
+        ->Args({20, 0})->Args({20, 1})->Args({100, 0})->Args({100, 1})->Args({1000, 0})->Args({1000, 1})
+        ->Unit(benchmark::kMicrosecond);
+
+/**
+ * Looks up the character searched last in the character set of a game, either with CharacterSet::findByUUID
+ * (argument 0) or in a CharacterIndex (1).
+ */
+static void BM_CharacterLookup(benchmark::State &state) {
+    auto gameState = bench::createState();
+    auto &characters = gameState.getCharacters();
+    CharacterIndex index;
+    index.rebuild(characters);
+    bool indexed = state.range(0) != 0;
+
+    spy::util::UUID id;
+    for (const auto &character : characters) {
+        id = character.getCharacterId();
+    }
+
+    for (auto _ : state) {
+        if (indexed) {
+            auto character = index.find(characters, id);
+            benchmark::DoNotOptimize(character);
+        } else {
+            auto character = characters.findByUUID(id);
+            benchmark::DoNotOptimize(character);
+        }
+    }
+}
+
+BENCHMARK(BM_CharacterLookup)->ArgName("indexed")->Arg(0)->Arg(1);
+
+/**
+ * Game over check after an operation without influence on the condition, either by evaluating the state with
+ * RoundUtils::isGameOver (argument 0) or with a GameOverTracker (1).
+ */
+static void BM_GameOverCheck(benchmark::State &state) {
+    auto gameState = bench::createState();
+    auto character = gameState.getCharacters().begin()->getCharacterId();
+    std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>> operations{
+            std::make_shared<spy::gameplay::RetireAction>(character)};
+    GameOverTracker tracker;
+    tracker.evaluate(gameState);
+    bool tracked = state.range(0) != 0;
+
+    for (auto _ : state) {
+        if (tracked) {
+            tracker.update(gameState, operations);
+            benchmark::DoNotOptimize(tracker.isGameOver(gameState));
+        } else {
+            benchmark::DoNotOptimize(spy::util::RoundUtils::isGameOver(gameState));
+        }
+    }
+}
+
+BENCHMARK(BM_GameOverCheck)->ArgName("tracked")->Arg(0)->Arg(1);
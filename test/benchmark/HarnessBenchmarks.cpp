@@ -0,0 +1,93 @@
+/**
+ * @file   HarnessBenchmarks.cpp
+ * @brief  Benchmarks driving the complete server in-process via the in-memory transport.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <benchmark/benchmark.h>
+#include <network/messages/RequestMetaInformation.hpp>
+#include <ServerHarness.hpp>
+
+namespace {
+    harness::ServerHarness createHarness() {
+        return harness::ServerHarness{std::string{SERVER017_CONFIG_DIR} + "/characters.json",
+                                      std::string{SERVER017_CONFIG_DIR} + "/matchconfig.match",
+                                      std::string{SERVER017_CONFIG_DIR} + "/scenario.scenario"};
+    }
+
+    /**
+     * @param latencies Sorted latencies
+     * @return The given percentile in microseconds
+     */
+    double percentile(const std::vector<std::chrono::nanoseconds> &latencies, std::size_t percent) {
+        if (latencies.empty()) {
+            return 0;
+        }
+        auto latency = latencies.at((latencies.size() - 1) * percent / 100);
+        return std::chrono::duration<double, std::micro>(latency).count();
+    }
+}
+
+/**
+ * Plays complete matches between two scripted players. Measures the game logic of the server including
+ * message decoding and serialization, but without any socket overhead.
+ */
+static void BM_MatchThroughput(benchmark::State &state) {
+    auto serverHarness = createHarness();
+    unsigned long operations = 0;
+
+    for (auto _ : state) {
+        operations += serverHarness.playMatch();
+    }
+
+    state.counters["operations"] = benchmark::Counter(static_cast<double>(operations),
+                                                      benchmark::Counter::kIsRate);
+    state.counters["operationsPerMatch"] = benchmark::Counter(static_cast<double>(operations),
+                                                              benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_MatchThroughput)->Unit(benchmark::kMillisecond);
+
+/**
+ * Plays complete matches like BM_MatchThroughput and reports the time the server took to handle an operation of
+ * a player (until it requests the next one, see HarnessClient::operationLatencies) as median and 99th
+ * percentile in microseconds.
+ */
+static void BM_TurnLatency(benchmark::State &state) {
+    auto serverHarness = createHarness();
+    std::vector<std::chrono::nanoseconds> latencies;
+
+    for (auto _ : state) {
+        serverHarness.playMatch(&latencies);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_us"] = percentile(latencies, 50);
+    state.counters["p99_us"] = percentile(latencies, 99);
+}
+
+BENCHMARK(BM_TurnLatency)->Unit(benchmark::kMillisecond);
+
+/**
+ * Round trip of a RequestMetaInformation through router, role filtering and FSM while a player waits in the
+ * lobby.
+ */
+static void BM_MetaInformationRoundTrip(benchmark::State &state) {
+    using namespace spy::network::messages;
+
+    auto serverHarness = createHarness();
+    auto &client = serverHarness.addClient("harness", spy::network::RoleEnum::PLAYER);
+    serverHarness.pump();
+
+    const std::string request = nlohmann::json(RequestMetaInformation{
+            client.id, {MetaInformationKey::CONFIGURATION_SCENARIO, MetaInformationKey::SPECTATOR_COUNT}}).dump();
+
+    for (auto _ : state) {
+        client.connection->receive(request);
+        auto replies = client.connection->takeSent();
+        benchmark::DoNotOptimize(replies);
+    }
+}
+
+BENCHMARK(BM_MetaInformationRoundTrip);
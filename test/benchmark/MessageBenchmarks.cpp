@@ -0,0 +1,205 @@
+/**
+ * @file   MessageBenchmarks.cpp
+ * @brief  Benchmarks for decoding inbound and serializing outbound messages.
+ */
+
+#include <benchmark/benchmark.h>
+#include <map>
+#include <network/messages/Hello.hpp>
+#include <network/messages/Reconnect.hpp>
+#include <network/messages/ItemChoice.hpp>
+#include <network/messages/EquipmentChoice.hpp>
+#include <network/messages/GameOperation.hpp>
+#include <network/messages/GameLeave.hpp>
+#include <network/messages/GameStatus.hpp>
+#include <network/messages/RequestGamePause.hpp>
+#include <network/messages/RequestMetaInformation.hpp>
+#include <network/messages/RequestReplay.hpp>
+#include <network/messages/HelloReply.hpp>
+#include <network/PayloadCache.hpp>
+#include <network/AddressableFrame.hpp>
+#include <util/RoundUtils.hpp>
+#include <util/Player.hpp>
+#include "AllocationCounter.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    using namespace spy::network::messages;
+
+    const spy::util::UUID clientId = spy::util::UUID::generate();
+
+    spy::util::UUID someCharacter() {
+        return bench::configs().characterInformations.front().getCharacterId();
+    }
+
+    Hello hello() {
+        return Hello{{}, "benchmark", spy::network::RoleEnum::PLAYER};
+    }
+
+    Reconnect reconnect() {
+        return Reconnect{clientId, spy::util::UUID::generate()};
+    }
+
+    ItemChoice itemChoice() {
+        return ItemChoice{clientId, someCharacter()};
+    }
+
+    EquipmentChoice equipmentChoice() {
+        std::map<spy::util::UUID, std::set<spy::gadget::GadgetEnum>> equipment;
+        equipment[someCharacter()] = {spy::gadget::GadgetEnum::HAIRDRYER, spy::gadget::GadgetEnum::JETPACK};
+        return EquipmentChoice{clientId, equipment};
+    }
+
+    GameOperation gameOperation() {
+        return GameOperation{clientId, std::make_shared<spy::gameplay::RetireAction>(someCharacter())};
+    }
+
+    GameLeave gameLeave() {
+        return GameLeave{clientId};
+    }
+
+    RequestGamePause requestGamePause() {
+        return RequestGamePause{clientId, true};
+    }
+
+    RequestMetaInformation requestMetaInformation() {
+        return RequestMetaInformation{clientId, {MetaInformationKey::CONFIGURATION_SCENARIO,
+                                                 MetaInformationKey::FACTION_PLAYER1,
+                                                 MetaInformationKey::GADGETS_PLAYER1}};
+    }
+
+    RequestReplay requestReplay() {
+        return RequestReplay{clientId};
+    }
+}
+
+/**
+ * Decoding work of MessageRouter::receiveListener for a single message: parsing, reading the container to
+ * determine the type and decoding the concrete message.
+ */
+template<typename MessageType>
+static void BM_DecodeMessage(benchmark::State &state, MessageType message) {
+    const std::string serialized = nlohmann::json(message).dump();
+
+    for (auto _ : state) {
+        auto messageJson = nlohmann::json::parse(serialized);
+        auto messageContainer = messageJson.get<spy::network::MessageContainer>();
+        benchmark::DoNotOptimize(messageContainer);
+        auto decoded = messageJson.get<MessageType>();
+        benchmark::DoNotOptimize(decoded);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(serialized.size()));
+}
+
+BENCHMARK_CAPTURE(BM_DecodeMessage, Hello, hello());
+BENCHMARK_CAPTURE(BM_DecodeMessage, Reconnect, reconnect());
+BENCHMARK_CAPTURE(BM_DecodeMessage, ItemChoice, itemChoice());
+BENCHMARK_CAPTURE(BM_DecodeMessage, EquipmentChoice, equipmentChoice());
+BENCHMARK_CAPTURE(BM_DecodeMessage, GameOperation, gameOperation());
+BENCHMARK_CAPTURE(BM_DecodeMessage, GameLeave, gameLeave());
+BENCHMARK_CAPTURE(BM_DecodeMessage, RequestGamePause, requestGamePause());
+BENCHMARK_CAPTURE(BM_DecodeMessage, RequestMetaInformation, requestMetaInformation());
+BENCHMARK_CAPTURE(BM_DecodeMessage, RequestReplay, requestReplay());
+
+/**
+ * Work done by actions::broadcastState for one broadcast: one state copy into a GameStatus, serialized once,
+ * patched with the known safe combinations and the client id and dumped for each player, then framed once for
+ * the spectators and addressed per spectator. The argument is the number of spectators, the allocations
+ * counter is the number of heap allocations per broadcast.
+ */
+static void BM_BroadcastState(benchmark::State &state) {
+    auto gameState = bench::createState();
+    auto activeCharacter = gameState.getCharacters().begin()->getCharacterId();
+    std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>> operations{
+            std::make_shared<spy::gameplay::RetireAction>(activeCharacter)};
+    std::map<Player, std::set<int>> knownCombinations{{Player::one, {}},
+                                                      {Player::two, {}}};
+    std::map<Player, spy::util::UUID> playerIds{{Player::one, spy::util::UUID::generate()},
+                                                {Player::two, spy::util::UUID::generate()}};
+    std::vector<spy::util::UUID> spectators(static_cast<std::size_t>(state.range(0)));
+    for (auto &id : spectators) {
+        id = spy::util::UUID::generate();
+    }
+
+    unsigned long allocations = 0;
+    for (auto _ : state) {
+        auto allocationsBefore = bench::allocations();
+        bool gameOver = spy::util::RoundUtils::isGameOver(gameState);
+        nlohmann::json serializedStatus = GameStatus({}, activeCharacter, operations, gameState, gameOver);
+
+        for (const auto &player : {Player::one, Player::two}) {
+            serializedStatus.at("state").at("mySafeCombinations") = knownCombinations.at(player);
+            serializedStatus["clientId"] = playerIds.at(player);
+            auto frame = serializedStatus.dump();
+            benchmark::DoNotOptimize(frame);
+        }
+
+        serializedStatus.at("state").at("mySafeCombinations") = std::set<int>{};
+        AddressableFrame spectatorFrame{std::move(serializedStatus)};
+        for (const auto &id : spectators) {
+            auto frame = spectatorFrame.addressedTo(id);
+            benchmark::DoNotOptimize(frame);
+        }
+        allocations += bench::allocations() - allocationsBefore;
+    }
+    state.counters["allocations"] = benchmark::Counter(static_cast<double>(allocations),
+                                                       benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * (state.range(0) + 2));
+}
+
+BENCHMARK(BM_BroadcastState)->ArgName("spectators")->Arg(0)->Arg(10)->Arg(100)->Arg(1000);
+
+/**
+ * Serialization of a HelloReply for one client, either of the complete message (argument 0) or by splicing
+ * the configurations from the PayloadCache (argument 1) like actions::HelloReply does.
+ */
+static void BM_HelloReply(benchmark::State &state) {
+    const auto &configs = bench::configs();
+    PayloadCache cache{configs.scenarioConfig, configs.matchConfig, configs.characterInformations};
+    auto sessionId = spy::util::UUID::generate();
+    bool cached = state.range(0) != 0;
+
+    for (auto _ : state) {
+        std::string frame;
+        if (cached) {
+            frame = cache.helloReply(clientId, sessionId);
+        } else {
+            nlohmann::json serializedMessage = HelloReply{clientId, sessionId, configs.scenarioConfig,
+                                                          configs.matchConfig, configs.characterInformations};
+            frame = serializedMessage.dump();
+        }
+        benchmark::DoNotOptimize(frame);
+    }
+}
+
+BENCHMARK(BM_HelloReply)->ArgName("cached")->Arg(0)->Arg(1);
+
+/**
+ * Serialization of a MetaInformation reply with all configuration keys, either of the complete message
+ * (argument 0) or from the PayloadCache (argument 1).
+ */
+static void BM_MetaInformationConfiguration(benchmark::State &state) {
+    const auto &configs = bench::configs();
+    PayloadCache cache{configs.scenarioConfig, configs.matchConfig, configs.characterInformations};
+    std::vector<MetaInformationKey> keys{MetaInformationKey::CONFIGURATION_SCENARIO,
+                                         MetaInformationKey::CONFIGURATION_MATCH_CONFIG,
+                                         MetaInformationKey::CONFIGURATION_CHARACTER_INFORMATION};
+    bool cached = state.range(0) != 0;
+
+    for (auto _ : state) {
+        std::string frame;
+        if (cached) {
+            frame = cache.metaInformation(clientId, keys, {});
+        } else {
+            std::map<MetaInformationKey, MetaInformation::Info> information{
+                    {MetaInformationKey::CONFIGURATION_SCENARIO,              configs.scenarioConfig},
+                    {MetaInformationKey::CONFIGURATION_MATCH_CONFIG,          configs.matchConfig},
+                    {MetaInformationKey::CONFIGURATION_CHARACTER_INFORMATION, configs.characterInformations}};
+            nlohmann::json serializedMessage = MetaInformation{clientId, information};
+            frame = serializedMessage.dump();
+        }
+        benchmark::DoNotOptimize(frame);
+    }
+}
+
+BENCHMARK(BM_MetaInformationConfiguration)->ArgName("cached")->Arg(0)->Arg(1);
@@ -0,0 +1,179 @@
+/**
+ * @file   RouterBenchmarks.cpp
+ * @brief  Benchmarks of the message path through the MessageRouter, reporting allocations per message.
+ */
+
+#include <benchmark/benchmark.h>
+#include <network/messages/ItemChoice.hpp>
+#include <network/messages/GameOperation.hpp>
+#include <network/messages/RequestMetaInformation.hpp>
+#include <network/messages/GameStatus.hpp>
+#include <network/MessageRouter.hpp>
+#include <network/transport/InMemoryTransport.hpp>
+#include "AllocationCounter.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    using namespace spy::network::messages;
+
+    /**
+     * Router on an in-memory transport with registered clients.
+     */
+    struct RouterFixture {
+        std::shared_ptr<transport::InMemoryTransport> transport = std::make_shared<transport::InMemoryTransport>();
+        MessageRouter router{transport};
+        std::vector<std::pair<spy::util::UUID, std::shared_ptr<transport::InMemoryConnection>>> clients;
+
+        explicit RouterFixture(std::size_t clientCount) {
+            for (std::size_t i = 0; i < clientCount; i++) {
+                auto id = spy::util::UUID::generate();
+                auto connection = transport->connect();
+                router.registerUUIDforConnection(id, connection);
+                clients.emplace_back(id, connection);
+            }
+        }
+
+        void clearOutboxes() {
+            for (auto &client : clients) {
+                auto sent = client.second->takeSent();
+                benchmark::DoNotOptimize(sent);
+            }
+        }
+    };
+
+    void reportAllocations(benchmark::State &state, unsigned long allocations) {
+        state.counters["allocations"] = benchmark::Counter(static_cast<double>(allocations),
+                                                           benchmark::Counter::kAvgIterations);
+    }
+
+    spy::util::UUID someCharacter() {
+        return bench::configs().characterInformations.front().getCharacterId();
+    }
+
+    GameStatus gameStatus() {
+        auto gameState = bench::createState();
+        auto activeCharacter = gameState.getCharacters().begin()->getCharacterId();
+        std::vector<std::shared_ptr<const spy::gameplay::BaseOperation>> operations{
+                std::make_shared<spy::gameplay::RetireAction>(activeCharacter)};
+        return GameStatus{{}, activeCharacter, operations, gameState, false};
+    }
+}
+
+/**
+ * A serialized message handed to the router as received frame, decoded and moved to the subscriber, which
+ * consumes it like the FSM would. The allocations counter is the number of heap allocations per message.
+ */
+template<typename MessageType>
+static void BM_RouteInbound(benchmark::State &state, MessageType message) {
+    RouterFixture fixture{1};
+    const auto &[clientId, connection] = fixture.clients.front();
+    message.setClientId(clientId);
+    const std::string frame = nlohmann::json(message).dump();
+
+    fixture.router.setRoleProvider([](const spy::util::UUID &) {
+        return std::optional<spy::network::RoleEnum>{spy::network::RoleEnum::PLAYER};
+    });
+    unsigned long received = 0;
+    fixture.router.addListener<MessageType>([&received](MessageType &&routed, const MessageRouter::connectionPtr &) {
+        MessageType consumed = std::move(routed);
+        benchmark::DoNotOptimize(consumed);
+        received++;
+    });
+
+    auto allocationsBefore = bench::allocations();
+    for (auto _ : state) {
+        connection->receive(frame);
+    }
+    reportAllocations(state, bench::allocations() - allocationsBefore);
+
+    if (received != static_cast<unsigned long>(state.iterations())) {
+        state.SkipWithError("Message was not routed to the subscriber");
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+
+BENCHMARK_CAPTURE(BM_RouteInbound, ItemChoice, ItemChoice{{}, someCharacter()});
+BENCHMARK_CAPTURE(BM_RouteInbound, GameOperation,
+                  GameOperation{{}, std::make_shared<spy::gameplay::RetireAction>(someCharacter())});
+BENCHMARK_CAPTURE(BM_RouteInbound, RequestMetaInformation,
+                  RequestMetaInformation{{}, {MetaInformationKey::CONFIGURATION_SCENARIO,
+                                              MetaInformationKey::SPECTATOR_COUNT}});
+
+/**
+ * A message the role of the sender may not send (a GameOperation of a spectator), rejected by the router before
+ * it is decoded.
+ */
+static void BM_RejectInbound(benchmark::State &state) {
+    RouterFixture fixture{1};
+    const auto &[clientId, connection] = fixture.clients.front();
+    const std::string frame = nlohmann::json(
+            GameOperation{clientId, std::make_shared<spy::gameplay::RetireAction>(someCharacter())}).dump();
+
+    fixture.router.setRoleProvider([](const spy::util::UUID &) {
+        return std::optional<spy::network::RoleEnum>{spy::network::RoleEnum::SPECTATOR};
+    });
+    unsigned long rejected = 0;
+    fixture.router.addIllegalMessageListener([&rejected](const spy::util::UUID &, MessageTypeEnum) {
+        rejected++;
+    });
+
+    auto allocationsBefore = bench::allocations();
+    for (auto _ : state) {
+        connection->receive(frame);
+    }
+    reportAllocations(state, bench::allocations() - allocationsBefore);
+
+    if (rejected != static_cast<unsigned long>(state.iterations())) {
+        state.SkipWithError("Message was not rejected");
+    }
+}
+
+BENCHMARK(BM_RejectInbound);
+
+/**
+ * MessageRouter::sendMessage of a GameStatus to one client, including the frame kept for a reconnect. The
+ * allocations counter is the number of heap allocations per message.
+ */
+static void BM_SendMessage(benchmark::State &state) {
+    RouterFixture fixture{1};
+    const auto &clientId = fixture.clients.front().first;
+    const auto message = gameStatus();
+
+    unsigned long allocations = 0;
+    for (auto _ : state) {
+        auto allocationsBefore = bench::allocations();
+        fixture.router.sendMessage(clientId, message);
+        allocations += bench::allocations() - allocationsBefore;
+
+        state.PauseTiming();
+        fixture.clearOutboxes();
+        state.ResumeTiming();
+    }
+    reportAllocations(state, allocations);
+}
+
+BENCHMARK(BM_SendMessage);
+
+/**
+ * MessageRouter::broadcastMessage of a GameStatus, the argument is the number of clients. The allocations
+ * counter is the number of heap allocations per broadcast.
+ */
+static void BM_BroadcastMessage(benchmark::State &state) {
+    RouterFixture fixture{static_cast<std::size_t>(state.range(0))};
+    const auto message = gameStatus();
+
+    unsigned long allocations = 0;
+    for (auto _ : state) {
+        auto allocationsBefore = bench::allocations();
+        fixture.router.broadcastMessage(message);
+        allocations += bench::allocations() - allocationsBefore;
+
+        state.PauseTiming();
+        fixture.clearOutboxes();
+        state.ResumeTiming();
+    }
+    reportAllocations(state, allocations);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_BroadcastMessage)->ArgName("clients")->Arg(2)->Arg(10)->Arg(100);
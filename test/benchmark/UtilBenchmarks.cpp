@@ -0,0 +1,65 @@
+/**
+ * @file   UtilBenchmarks.cpp
+ * @brief  Benchmarks for the timer and the json formatting used for logging.
+ */
+
+#include <benchmark/benchmark.h>
+#include <network/messages/GameOperation.hpp>
+#include <util/Format.hpp>
+#include <util/Timer.hpp>
+#include "Fixtures.hpp"
+
+/**
+ * Arms a timer and cancels it before it expires, as done for every requested operation.
+ */
+static void BM_TimerArmCancel(benchmark::State &state) {
+    SystemClock clock;
+    Timer timer;
+
+    for (auto _ : state) {
+        // short timeout, every arm starts a thread that lives until the timeout is reached
+        timer.restart(clock, std::chrono::milliseconds{1}, []() {});
+        timer.stop();
+    }
+}
+
+BENCHMARK(BM_TimerArmCancel);
+
+/**
+ * Same as BM_TimerArmCancel on the virtual clock, cancelled timers are pruned while arming new ones.
+ */
+static void BM_VirtualTimerArmCancel(benchmark::State &state) {
+    VirtualClock clock;
+    Timer timer;
+
+    for (auto _ : state) {
+        timer.restart(clock, std::chrono::seconds{30}, []() {});
+        timer.stop();
+    }
+}
+
+BENCHMARK(BM_VirtualTimerArmCancel);
+
+static void BM_FormatJsonState(benchmark::State &state) {
+    auto gameState = bench::createState();
+
+    for (auto _ : state) {
+        auto formatted = fmt::json(gameState);
+        benchmark::DoNotOptimize(formatted);
+    }
+}
+
+BENCHMARK(BM_FormatJsonState);
+
+static void BM_FormatJsonOperation(benchmark::State &state) {
+    auto characterId = bench::configs().characterInformations.front().getCharacterId();
+    spy::network::messages::GameOperation operation{spy::util::UUID::generate(),
+                                                    std::make_shared<spy::gameplay::RetireAction>(characterId)};
+
+    for (auto _ : state) {
+        auto formatted = fmt::json(operation);
+        benchmark::DoNotOptimize(formatted);
+    }
+}
+
+BENCHMARK(BM_FormatJsonOperation);
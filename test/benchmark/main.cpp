@@ -0,0 +1,34 @@
+/**
+ * @file   main.cpp
+ * @brief  Entry point of the benchmarks, reports as JSON unless another format is requested.
+ */
+
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+    std::vector<char *> args{argv, argv + argc};
+    std::string jsonFormat = "--benchmark_format=json";
+
+    bool formatGiven = false;
+    for (const auto arg : args) {
+        formatGiven |= (std::strncmp(arg, "--benchmark_format", std::strlen("--benchmark_format")) == 0);
+    }
+    if (not formatGiven) {
+        args.push_back(jsonFormat.data());
+    }
+
+    // the code under test logs heavily, which would dominate the measurements
+    spdlog::set_level(spdlog::level::level_enum::off);
+
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
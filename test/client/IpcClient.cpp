@@ -0,0 +1,94 @@
+/**
+ * @file   IpcClient.cpp
+ * @brief  Implementation of the unix socket client.
+ */
+
+#include "IpcClient.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+IpcClient::IpcClient(const std::string &path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error{"Invalid unix socket path " + path};
+    }
+    path.copy(address.sun_path, path.size());
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 or ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        auto error = std::runtime_error{"Could not connect to " + path + ": " + std::strerror(errno)};
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw error;
+    }
+
+    receiveThread = std::thread{&IpcClient::receive, this};
+}
+
+IpcClient::~IpcClient() {
+    closing = true;
+    ::shutdown(fd, SHUT_RDWR);
+    receiveThread.join();
+    ::close(fd);
+}
+
+void IpcClient::send(const std::string &message) {
+    std::string frame;
+    frame.reserve(message.size() + 4);
+    for (unsigned int shift = 0; shift < 32; shift += 8) {
+        frame += static_cast<char>((message.size() >> shift) & 0xFFu);
+    }
+    frame += message;
+
+    std::lock_guard<std::mutex> lock{sendMutex};
+    std::size_t sent = 0;
+    while (sent < frame.size()) {
+        auto written = ::send(fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        sent += static_cast<std::size_t>(written);
+    }
+}
+
+void IpcClient::receive() {
+    std::string input;
+    char buffer[64 * 1024];
+    while (true) {
+        auto received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 and errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            if (not closing) {
+                closeListener();
+            }
+            return;
+        }
+        input.append(buffer, static_cast<std::size_t>(received));
+
+        std::size_t offset = 0;
+        while (input.size() - offset >= 4) {
+            std::size_t length = 0;
+            for (std::size_t i = 0; i < 4; i++) {
+                length |= static_cast<std::size_t>(static_cast<uint8_t>(input[offset + i])) << (8 * i);
+            }
+            if (input.size() - offset - 4 < length) {
+                break;
+            }
+            receiveListener(input.substr(offset + 4, length));
+            offset += 4 + length;
+        }
+        input.erase(0, offset);
+    }
+}
@@ -0,0 +1,57 @@
+/**
+ * @file   IpcClient.hpp
+ * @brief  Client side of the unix socket transport of the server.
+ */
+
+#ifndef SERVER017_IPC_CLIENT_HPP
+#define SERVER017_IPC_CLIENT_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <Util/Listener.hpp>
+
+/**
+ * Connects to the unix domain socket of a server started with --x ipcSocket. Messages are sent and received with
+ * a 4 byte little-endian length prefix instead of WebSocket framing.
+ */
+class IpcClient {
+    public:
+        /**
+         * Connects to the socket and starts receiving.
+         * @throws std::runtime_error if the socket can not be connected
+         */
+        explicit IpcClient(const std::string &path);
+
+        IpcClient(const IpcClient &other) = delete;
+
+        IpcClient &operator=(const IpcClient &other) = delete;
+
+        /**
+         * Closes the connection and waits for the receiving thread.
+         */
+        ~IpcClient();
+
+        void send(const std::string &message);
+
+        /**
+         * Called from the receiving thread for every message.
+         */
+        const websocket::util::Listener<std::string> receiveListener;
+
+        /**
+         * Called from the receiving thread if the server closed the connection.
+         */
+        const websocket::util::Listener<> closeListener;
+
+    private:
+        int fd;
+        std::atomic<bool> closing = false;
+        std::mutex sendMutex;
+        std::thread receiveThread;
+
+        void receive();
+};
+
+#endif //SERVER017_IPC_CLIENT_HPP
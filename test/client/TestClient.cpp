@@ -0,0 +1,257 @@
+/**
+ * @file   TestClient.cpp
+ * @author jonas
+ * @date   19.04.2020 (creation)
+ * @brief  Implementation of the scripted test client.
+ */
+
+#include "TestClient.hpp"
+#include <spdlog/spdlog.h>
+#include <network/messages/Hello.hpp>
+#include <network/messages/HelloReply.hpp>
+#include <network/messages/ItemChoice.hpp>
+#include <network/messages/RequestItemChoice.hpp>
+#include <network/messages/RequestEquipmentChoice.hpp>
+#include <network/messages/EquipmentChoice.hpp>
+#include <network/messages/RequestGamePause.hpp>
+#include <network/messages/GameLeave.hpp>
+#include <network/messages/GameOperation.hpp>
+#include <network/messages/GameStatus.hpp>
+#include <network/messages/RequestGameOperation.hpp>
+#include <network/messages/RequestMetaInformation.hpp>
+#include <network/messages/MetaInformation.hpp>
+#include <network/messages/Reconnect.hpp>
+#include <gameLogic/generation/ActionGenerator.hpp>
+#include <util/Format.hpp>
+
+TestClient::TestClient(std::string clientName, spy::network::RoleEnum clientRole, std::string serverHost,
+                       uint16_t serverPort, MessageHook hook) :
+        name(std::move(clientName)),
+        role(clientRole),
+        host(std::move(serverHost)),
+        port(serverPort),
+        messageHook(std::move(hook)) {
+    connect();
+
+    if (role == spy::network::RoleEnum::PLAYER || role == spy::network::RoleEnum::AI) {
+        // decide randomly how many characters are chosen [2 - 4]
+        std::uniform_int_distribution<unsigned int> randNum(2, 4);
+        numberOfCharacters = randNum(rng);
+
+        spdlog::trace("{} will choose {} characters and {} gadgets", name, numberOfCharacters,
+                      8 - numberOfCharacters);
+    }
+}
+
+void TestClient::send(const nlohmann::json &message) {
+    if (ipcClient != nullptr) {
+        ipcClient->send(message.dump());
+    } else {
+        wsClient.value().send(message.dump());
+    }
+    sentMessages++;
+}
+
+void TestClient::sendChoice(std::variant<spy::util::UUID, spy::gadget::GadgetEnum> choice) {
+    spy::network::messages::ItemChoice message(id, choice);
+    send(message);
+
+    spdlog::info("{} sent item choice\n", name);
+}
+
+void TestClient::sendEquipmentChoice(std::map<spy::util::UUID, std::set<spy::gadget::GadgetEnum>> choice) {
+    spy::network::messages::EquipmentChoice message(id, choice);
+    send(message);
+
+    spdlog::info("{} sent equipment choice\n", name);
+}
+
+void TestClient::sendHello() {
+    send(spy::network::messages::Hello{id, name, role});
+}
+
+void TestClient::sendRequestPause(bool pause) {
+    send(spy::network::messages::RequestGamePause{id, pause});
+}
+
+void TestClient::sendGameLeave() {
+    send(spy::network::messages::GameLeave{id});
+}
+
+void TestClient::requestMetaInformation() {
+    spdlog::info("{}: requesting meta information", name);
+
+    using namespace spy::network::messages;
+    auto msg = RequestMetaInformation{id, {MetaInformationKey::CONFIGURATION_SCENARIO,
+                                           MetaInformationKey::SPECTATOR_COUNT,
+            // Expected: only own characters get returned
+                                           MetaInformationKey::FACTION_PLAYER1,
+                                           MetaInformationKey::FACTION_PLAYER2,
+                                           MetaInformationKey::FACTION_NEUTRAL,
+                                           MetaInformationKey::GADGETS_PLAYER1,
+                                           MetaInformationKey::GADGETS_PLAYER2}};
+    send(msg);
+}
+
+void TestClient::sendOperation(const spy::util::UUID &characterId) {
+    std::shared_ptr<spy::gameplay::BaseOperation> operation;
+    if (lastState.has_value() and matchConfig.has_value()) {
+        operation = spy::gameplay::ActionGenerator::generateNPCAction(lastState.value(), characterId,
+                                                                      matchConfig.value());
+    }
+
+    if (operation == nullptr) {
+        spdlog::warn("{} could not generate an operation for {}, retiring instead", name, characterId);
+        operation = std::make_shared<spy::gameplay::RetireAction>(characterId);
+    }
+
+    operationSentAt = clock::now();
+    send(spy::network::messages::GameOperation{id, operation});
+}
+
+void TestClient::connect() {
+    const std::string unixPrefix = "unix:";
+    if (host.rfind(unixPrefix, 0) == 0) {
+        ipcClient = std::make_unique<IpcClient>(host.substr(unixPrefix.size()));
+        ipcClient->closeListener.subscribe([clientName = name]() {
+            spdlog::critical("{}: Connection Closed", clientName);
+        });
+        ipcClient->receiveListener.subscribe([this](const std::string &message) {
+            handleMessage(message);
+        });
+        return;
+    }
+
+    wsClient.emplace(host, "/", port, "no-time-to-spy");
+
+    wsClient.value().closeListener.subscribe([clientName = name]() {
+        spdlog::critical("{}: Connection Closed", clientName);
+    });
+
+    wsClient.value().receiveListener.subscribe([this](const std::string &message) {
+        handleMessage(message);
+    });
+}
+
+void TestClient::handleMessage(const std::string &message) {
+    using spy::network::messages::MessageTypeEnum;
+
+    spdlog::trace("{}: {}", name, message);
+
+    auto j = nlohmann::json::parse(message);
+    auto container = j.get<spy::network::MessageContainer>();
+
+    switch (container.getType()) {
+        case MessageTypeEnum::REQUEST_ITEM_CHOICE: {
+            std::variant<spy::util::UUID, spy::gadget::GadgetEnum> choice;
+            auto offer = j.get<spy::network::messages::RequestItemChoice>();
+
+            spdlog::info("{} received Request item choice nr. {}", name, choiceCounter);
+            std::uniform_int_distribution<unsigned int> randNum(0, 2);
+            auto chosenIdx = randNum(rng);
+
+            if (choiceCounter < numberOfCharacters) {
+                choice = offer.getOfferedCharacterIds()[chosenIdx];
+            } else if (choiceCounter < 8) {
+                choice = offer.getOfferedGadgets()[chosenIdx];
+            } else {
+                spdlog::critical("### ERROR, server offering to many rounds! ###");
+                std::exit(1);
+            }
+
+            sendChoice(choice);
+            choiceCounter++;
+            break;
+        }
+
+        case MessageTypeEnum::REQUEST_EQUIPMENT_CHOICE: {
+            auto m = j.get<spy::network::messages::RequestEquipmentChoice>();
+
+            spdlog::info("{} received Request equipment choice", name);
+
+            std::map<spy::util::UUID, std::set<spy::gadget::GadgetEnum>> choice;
+
+            // Add all characters with empty gadget set to the map
+            for (const auto &c : m.getChosenCharacterIds()) {
+                choice[c] = std::set<spy::gadget::GadgetEnum>();
+            }
+
+            // decide randomly to which character the gadget is added
+            std::uniform_int_distribution<unsigned int> randNum(0, numberOfCharacters - 1);
+            for (const auto g : m.getChosenGadgets()) {
+                auto charNum = randNum(rng);
+                choice.at(m.getChosenCharacterIds().at(charNum)).insert(g);
+            }
+
+            sendEquipmentChoice(choice);
+            choiceCounter++;
+            break;
+        }
+
+        case MessageTypeEnum::HELLO_REPLY: {
+            auto m = j.get<spy::network::messages::HelloReply>();
+            id = m.getClientId();
+            sessionId = m.getSessionId();
+            matchConfig = j.at("settings").get<spy::MatchConfig>();
+
+            spdlog::info("{} was assigned id: {}, sessionId is {}",
+                         name,
+                         id.to_string(),
+                         sessionId.to_string());
+            break;
+        }
+
+        case MessageTypeEnum::META_INFORMATION: {
+            auto m = j.get<spy::network::messages::MetaInformation>();
+            auto map = m.getInformation();
+
+            std::string keys;
+
+            for (const auto &[key, value] : map) {
+                keys += fmt::json(key);
+            }
+
+            spdlog::info("{} received keys {}", name, keys);
+            break;
+        }
+
+        case MessageTypeEnum::GAME_STATUS: {
+            auto m = j.get<spy::network::messages::GameStatus>();
+            lastState = m.getState();
+            spdlog::debug("{} received game status for round {}", name, m.getState().getCurrentRound());
+            break;
+        }
+
+        case MessageTypeEnum::REQUEST_GAME_OPERATION: {
+            auto m = j.get<spy::network::messages::RequestGameOperation>();
+            spdlog::debug("{} received operation request for {}", name, m.getCharacterId());
+            if (playOperations) {
+                sendOperation(m.getCharacterId());
+            }
+            break;
+        }
+
+        default:
+            spdlog::warn("{} received unhandled message : {}", name, message);
+            break;
+    }
+
+    if (messageHook) {
+        messageHook(container, j);
+    }
+}
+
+void TestClient::disconnect() {
+    wsClient.reset();
+    ipcClient.reset();
+}
+
+void TestClient::reconnect(bool wrongSessionId) {
+    connect();
+
+    if (wrongSessionId) {
+        send(spy::network::messages::Reconnect{id, spy::util::UUID::generate()});
+    } else {
+        send(spy::network::messages::Reconnect{id, sessionId});
+    }
+}
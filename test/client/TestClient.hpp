@@ -0,0 +1,102 @@
+/**
+ * @file   TestClient.hpp
+ * @author jonas
+ * @date   19.04.2020 (creation)
+ * @brief  Scripted client used by the manual test client and the load generator.
+ */
+
+#ifndef SERVER017_TEST_CLIENT_HPP
+#define SERVER017_TEST_CLIENT_HPP
+
+#include <Client/WebSocketClient.hpp>
+#include "IpcClient.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <variant>
+#include <network/RoleEnum.hpp>
+#include <network/MessageContainer.hpp>
+#include <datatypes/gadgets/GadgetEnum.hpp>
+#include <datatypes/matchconfig/MatchConfig.hpp>
+#include <datatypes/gameplay/State.hpp>
+#include <util/UUID.hpp>
+
+struct TestClient {
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * Called for every received message after the default handling.
+     * @note Gets called from the network thread of the websocket client.
+     */
+    using MessageHook = std::function<void(const spy::network::MessageContainer &container,
+                                           const nlohmann::json &message)>;
+
+    spy::util::UUID id;
+    std::optional<websocket::network::WebSocketClient> wsClient;
+    std::unique_ptr<IpcClient> ipcClient;               ///< Used instead of wsClient for "unix:<path>" hosts
+    std::string name;
+    spy::network::RoleEnum role;
+    spy::util::UUID sessionId;
+    std::string host;
+    uint16_t port;
+    unsigned int choiceCounter = 0;
+    unsigned int numberOfCharacters = 0;
+    std::random_device rd{};
+    std::mt19937 rng{rd()};
+
+    /**
+     * If set, RequestGameOperation messages are answered with a generated operation for the requested
+     * character, otherwise these requests are only logged.
+     */
+    bool playOperations = false;
+
+    MessageHook messageHook;
+
+    std::optional<spy::MatchConfig> matchConfig;        ///< Received with the HelloReply
+    std::optional<spy::gameplay::State> lastState;      ///< Received with the last GameStatus
+    std::optional<clock::time_point> operationSentAt;   ///< Reset once the following GameStatus arrives
+
+    std::atomic<unsigned long> sentMessages = 0;        ///< Frames sent since creation
+
+    /**
+     * @param serverHost Host of the server, or "unix:<path>" to connect to the unix socket of the server
+     */
+    explicit TestClient(std::string clientName,
+                        spy::network::RoleEnum clientRole = spy::network::RoleEnum::PLAYER,
+                        std::string serverHost = "localhost",
+                        uint16_t serverPort = 7007,
+                        MessageHook hook = {});
+
+    void sendChoice(std::variant<spy::util::UUID, spy::gadget::GadgetEnum> choice);
+
+    void sendEquipmentChoice(std::map<spy::util::UUID, std::set<spy::gadget::GadgetEnum>> choice);
+
+    void sendHello();
+
+    void sendRequestPause(bool pause);
+
+    void sendGameLeave();
+
+    void requestMetaInformation();
+
+    void connect();
+
+    void disconnect();
+
+    void reconnect(bool wrongSessionId = false);
+
+    private:
+        void send(const nlohmann::json &message);
+
+        void handleMessage(const std::string &message);
+
+        void sendOperation(const spy::util::UUID &characterId);
+};
+
+#endif //SERVER017_TEST_CLIENT_HPP
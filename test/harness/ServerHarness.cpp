@@ -0,0 +1,239 @@
+/**
+ * @file   ServerHarness.cpp
+ * @brief  Implementation of the in-process server harness.
+ */
+
+#include "ServerHarness.hpp"
+#include <set>
+#include <stdexcept>
+#include <variant>
+#include <spdlog/spdlog.h>
+#include <network/MessageContainer.hpp>
+#include <network/messages/Hello.hpp>
+#include <network/messages/Reconnect.hpp>
+#include <network/messages/RequestGamePause.hpp>
+#include <network/messages/HelloReply.hpp>
+#include <network/messages/ItemChoice.hpp>
+#include <network/messages/RequestItemChoice.hpp>
+#include <network/messages/RequestEquipmentChoice.hpp>
+#include <network/messages/EquipmentChoice.hpp>
+#include <network/messages/GameOperation.hpp>
+#include <network/messages/GameStatus.hpp>
+#include <network/messages/RequestGameOperation.hpp>
+#include <gameLogic/generation/ActionGenerator.hpp>
+
+namespace harness {
+    static std::map<std::string, std::string> withoutLogFile(std::map<std::string, std::string> options) {
+        options.emplace("logFile", "none");
+        return options;
+    }
+
+    HarnessClient::HarnessClient(std::shared_ptr<transport::InMemoryConnection> connection, std::string name,
+                                 spy::network::RoleEnum role, unsigned int seed) :
+            connection{std::move(connection)},
+            name{std::move(name)},
+            role{role},
+            rng{seed} {
+        // decide randomly how many characters are chosen [2 - 4]
+        std::uniform_int_distribution<unsigned int> randNum(2, 4);
+        numberOfCharacters = randNum(rng);
+    }
+
+    void HarnessClient::send(const nlohmann::json &message) {
+        connection->receive(message.dump());
+    }
+
+    void HarnessClient::sendHello() {
+        send(spy::network::messages::Hello{id, name, role});
+    }
+
+    void HarnessClient::sendRequestPause(bool pause) {
+        send(spy::network::messages::RequestGamePause{id, pause});
+    }
+
+    std::size_t HarnessClient::poll() {
+        auto frames = connection->takeSent();
+        for (const auto &frame : frames) {
+            handleMessage(nlohmann::json::parse(frame));
+        }
+        return frames.size();
+    }
+
+    void HarnessClient::handleMessage(const nlohmann::json &message) {
+        using spy::network::messages::MessageTypeEnum;
+
+        receivedMessages++;
+        if (keepMessages) {
+            received.push_back(message);
+        }
+
+        auto container = message.get<spy::network::MessageContainer>();
+        receivedByType[container.getType()]++;
+        switch (container.getType()) {
+            case MessageTypeEnum::HELLO_REPLY: {
+                auto m = message.get<spy::network::messages::HelloReply>();
+                id = m.getClientId();
+                sessionId = m.getSessionId();
+                matchConfig = message.at("settings").get<spy::MatchConfig>();
+                break;
+            }
+
+            case MessageTypeEnum::REQUEST_ITEM_CHOICE: {
+                auto offer = message.get<spy::network::messages::RequestItemChoice>();
+                std::uniform_int_distribution<unsigned int> randNum(0, 2);
+                std::variant<spy::util::UUID, spy::gadget::GadgetEnum> choice;
+                if (choiceCounter < numberOfCharacters) {
+                    choice = offer.getOfferedCharacterIds().at(randNum(rng));
+                } else {
+                    choice = offer.getOfferedGadgets().at(randNum(rng));
+                }
+                choiceCounter++;
+                send(spy::network::messages::ItemChoice{id, choice});
+                break;
+            }
+
+            case MessageTypeEnum::REQUEST_EQUIPMENT_CHOICE: {
+                auto m = message.get<spy::network::messages::RequestEquipmentChoice>();
+                std::map<spy::util::UUID, std::set<spy::gadget::GadgetEnum>> choice;
+                for (const auto &c : m.getChosenCharacterIds()) {
+                    choice[c] = {};
+                }
+
+                std::uniform_int_distribution<std::size_t> randNum(0, m.getChosenCharacterIds().size() - 1);
+                for (const auto g : m.getChosenGadgets()) {
+                    choice.at(m.getChosenCharacterIds().at(randNum(rng))).insert(g);
+                }
+                send(spy::network::messages::EquipmentChoice{id, choice});
+                break;
+            }
+
+            case MessageTypeEnum::GAME_STATUS:
+                lastState = message.get<spy::network::messages::GameStatus>().getState();
+                break;
+
+            case MessageTypeEnum::REQUEST_GAME_OPERATION: {
+                if (not playOperations) {
+                    break;
+                }
+                auto characterId = message.get<spy::network::messages::RequestGameOperation>().getCharacterId();
+                std::shared_ptr<spy::gameplay::BaseOperation> operation;
+                if (lastState.has_value() and matchConfig.has_value()) {
+                    operation = spy::gameplay::ActionGenerator::generateNPCAction(lastState.value(), characterId,
+                                                                                  matchConfig.value());
+                }
+                if (operation == nullptr) {
+                    operation = std::make_shared<spy::gameplay::RetireAction>(characterId);
+                }
+                sentOperations++;
+                // The in-memory transport hands the message to the server synchronously
+                auto frame = nlohmann::json(spy::network::messages::GameOperation{id, operation}).dump();
+                auto start = std::chrono::steady_clock::now();
+                connection->receive(frame);
+                operationLatencies.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start));
+                break;
+            }
+
+            case MessageTypeEnum::STATISTICS:
+                gameOver = true;
+                winner = message.at("winner").get<spy::util::UUID>();
+                victoryReason = message.at("reason").get<spy::statistics::VictoryEnum>();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    ServerHarness::ServerHarness(const std::string &characterPath, const std::string &matchPath,
+                                 const std::string &scenarioPath, std::map<std::string, std::string> options,
+                                 unsigned int verbosity) :
+            transport{std::make_shared<transport::InMemoryTransport>()},
+            virtualClock{std::make_shared<VirtualClock>()},
+            fsm{transport, verbosity, characterPath, matchPath, scenarioPath, withoutLogFile(std::move(options)),
+                virtualClock} {}
+
+    HarnessClient &ServerHarness::addClient(const std::string &name, spy::network::RoleEnum role) {
+        clients.push_back(std::make_unique<HarnessClient>(transport->connect(), name, role, nextSeed++));
+        auto &client = *clients.back();
+        client.sendHello();
+        return client;
+    }
+
+    void ServerHarness::disconnect(HarnessClient &client) {
+        transport->close(client.connection);
+    }
+
+    void ServerHarness::reconnect(HarnessClient &client, bool wrongSessionId) {
+        client.connection = transport->connect();
+        client.send(spy::network::messages::Reconnect{
+                client.id, wrongSessionId ? spy::util::UUID::generate() : client.sessionId});
+    }
+
+    std::size_t ServerHarness::advance(Clock::duration timeSpan) {
+        const auto until = virtualClock->now() + timeSpan;
+        std::size_t expired = 0;
+        pump();
+
+        // Expire timers one point in time after another, clients may react to each of them
+        for (auto next = virtualClock->nextExpiry(); next.has_value() and next.value() <= until;
+             next = virtualClock->nextExpiry()) {
+            expired += virtualClock->advance(next.value() - virtualClock->now());
+            pump();
+        }
+
+        virtualClock->advance(until - virtualClock->now());
+        return expired;
+    }
+
+    std::size_t ServerHarness::pump() {
+        std::size_t handled = 0;
+        std::size_t handledThisPass;
+        do {
+            handledThisPass = 0;
+            for (auto &client : clients) {
+                handledThisPass += client->poll();
+            }
+            handled += handledThisPass;
+        } while (handledThisPass > 0);
+        return handled;
+    }
+
+    unsigned long ServerHarness::playMatch(std::vector<std::chrono::nanoseconds> *operationLatencies) {
+        clients.clear();
+        auto &one = addClient("harness1", spy::network::RoleEnum::PLAYER);
+        auto &two = addClient("harness2", spy::network::RoleEnum::PLAYER);
+        pump();
+
+        if (not one.gameOver or not two.gameOver) {
+            throw std::runtime_error{"Server stopped sending before the match was over"};
+        }
+        if (operationLatencies != nullptr) {
+            for (const auto *client : {&one, &two}) {
+                operationLatencies->insert(operationLatencies->end(), client->operationLatencies.begin(),
+                                           client->operationLatencies.end());
+            }
+        }
+        return one.sentOperations + two.sentOperations;
+    }
+
+    MatchResult ServerHarness::playSeededMatch(unsigned int seed) {
+        nextSeed = seed;
+        auto operations = playMatch();
+
+        const auto &one = *clients.at(0);
+        if (not one.winner.has_value() or not one.victoryReason.has_value() or not one.lastState.has_value()) {
+            throw std::runtime_error{"Statistics message of the match is incomplete"};
+        }
+        return MatchResult{one.winner.value() == one.id ? Player::one : Player::two, one.victoryReason.value(),
+                           one.lastState->getCurrentRound(), operations};
+    }
+
+    afsm::state_machine<Server> &ServerHarness::server() {
+        return fsm;
+    }
+
+    VirtualClock &ServerHarness::clock() {
+        return *virtualClock;
+    }
+}
@@ -0,0 +1,167 @@
+/**
+ * @file   ServerHarness.hpp
+ * @brief  Runs the server FSM in-process on an in-memory transport, without sockets.
+ */
+
+#ifndef SERVER017_SERVER_HARNESS_HPP
+#define SERVER017_SERVER_HARNESS_HPP
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <network/RoleEnum.hpp>
+#include <network/messages/MessageTypeEnum.hpp>
+#include <datatypes/matchconfig/MatchConfig.hpp>
+#include <datatypes/gameplay/State.hpp>
+#include <datatypes/statistics/VictoryEnum.hpp>
+#include <network/transport/InMemoryTransport.hpp>
+#include <util/UUID.hpp>
+#include <util/Clock.hpp>
+#include <Server.hpp>
+
+namespace harness {
+    /**
+     * Scripted client on an in-memory connection. Players answer all requests of the server: random item
+     * choices, random equipment and operations generated like NPC operations.
+     */
+    struct HarnessClient {
+        std::shared_ptr<transport::InMemoryConnection> connection;
+        std::string name;
+        spy::network::RoleEnum role;
+        spy::util::UUID id;
+        spy::util::UUID sessionId;
+        std::mt19937 rng;
+
+        unsigned int choiceCounter = 0;
+        unsigned int numberOfCharacters;
+
+        std::optional<spy::MatchConfig> matchConfig;        ///< Received with the HelloReply
+        std::optional<spy::gameplay::State> lastState;      ///< Received with the last GameStatus
+
+        /**
+         * If not set, RequestGameOperation messages are left unanswered, e.g. to provoke strikes.
+         */
+        bool playOperations = true;
+
+        unsigned long receivedMessages = 0;
+        std::map<spy::network::messages::MessageTypeEnum, unsigned int> receivedByType;
+        unsigned long sentOperations = 0;
+
+        /**
+         * Time the server took to handle each sent operation, i.e. until it waits for the next operation or
+         * the match is over. Includes all NPC and cat operations that followed.
+         */
+        std::vector<std::chrono::nanoseconds> operationLatencies;
+        bool gameOver = false;                              ///< Set once the Statistics message arrived
+        std::optional<spy::util::UUID> winner;              ///< Received with the Statistics message
+        std::optional<spy::statistics::VictoryEnum> victoryReason;  ///< Received with the Statistics message
+
+        /**
+         * If set, every received message is additionally stored in received.
+         */
+        bool keepMessages = false;
+        std::vector<nlohmann::json> received;
+
+        HarnessClient(std::shared_ptr<transport::InMemoryConnection> connection, std::string name,
+                      spy::network::RoleEnum role, unsigned int seed);
+
+        void send(const nlohmann::json &message);
+
+        void sendHello();
+
+        void sendRequestPause(bool pause);
+
+        /**
+         * Handles all messages the server sent since the last call.
+         * @return Number of handled messages
+         */
+        std::size_t poll();
+
+        private:
+            void handleMessage(const nlohmann::json &message);
+    };
+
+    /**
+     * Outcome of a match played with ServerHarness::playSeededMatch.
+     */
+    struct MatchResult {
+        Player winner;
+        spy::statistics::VictoryEnum reason;
+        unsigned int rounds;
+        unsigned long operations;
+    };
+
+    /**
+     * Server FSM on an in-memory transport. Clients are driven by calling pump, which lets every client handle
+     * its messages until the server stops sending. The server runs on a VirtualClock, so timers only expire
+     * when advance is called and everything runs in the calling thread.
+     */
+    class ServerHarness {
+        public:
+            /**
+             * Creates the server. The file log sink is disabled unless the options contain "logFile".
+             */
+            ServerHarness(const std::string &characterPath, const std::string &matchPath,
+                          const std::string &scenarioPath, std::map<std::string, std::string> options = {},
+                          unsigned int verbosity = 1);
+
+            /**
+             * Connects a new client, players and spectators send Hello immediately.
+             */
+            HarnessClient &addClient(const std::string &name, spy::network::RoleEnum role);
+
+            /**
+             * Closes the connection of the client as if it had disconnected.
+             */
+            void disconnect(HarnessClient &client);
+
+            /**
+             * Opens a new connection for the client and sends Reconnect.
+             * @param wrongSessionId Send a random session id instead of the one from the HelloReply
+             */
+            void reconnect(HarnessClient &client, bool wrongSessionId = false);
+
+            /**
+             * Moves the clock of the server forward, letting clients react to every expired timer.
+             * @return Number of expired timers
+             */
+            std::size_t advance(Clock::duration timeSpan);
+
+            /**
+             * Lets all clients handle their messages until no client receives anything new.
+             * @return Number of handled messages
+             */
+            std::size_t pump();
+
+            /**
+             * Connects two players and pumps until the match is over.
+             * @param operationLatencies If given, the operation latencies of both players are appended
+             * @return Number of operations sent by the players
+             */
+            unsigned long playMatch(std::vector<std::chrono::nanoseconds> *operationLatencies = nullptr);
+
+            /**
+             * Plays a match like playMatch, the random choices and operations of the players are seeded with seed
+             * and seed + 1.
+             */
+            MatchResult playSeededMatch(unsigned int seed);
+
+            afsm::state_machine<Server> &server();
+
+            VirtualClock &clock();
+
+        private:
+            std::shared_ptr<transport::InMemoryTransport> transport;
+            std::shared_ptr<VirtualClock> virtualClock;
+            afsm::state_machine<Server> fsm;
+            std::vector<std::unique_ptr<HarnessClient>> clients;
+            unsigned int nextSeed = 0;
+    };
+}
+
+#endif //SERVER017_SERVER_HARNESS_HPP
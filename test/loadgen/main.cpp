@@ -0,0 +1,259 @@
+/**
+ * @file   main.cpp
+ * @brief  Load generator playing complete matches with bot pairs and spectators against local servers.
+ * @details Every server instance hosts exactly one match at a time, thus bot pair i connects to port
+ *          basePort + i. Start one server per pair before running the load generator.
+ */
+
+#include <CLI/CLI.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TestClient.hpp"
+
+using spy::network::messages::MessageTypeEnum;
+
+/**
+ * Statistics shared by all bot pairs.
+ */
+struct LoadStatistics {
+    std::atomic<unsigned long> receivedMessages = 0;
+    std::atomic<unsigned long> sentMessages = 0;
+    std::atomic<unsigned long> finishedGames = 0;
+    std::atomic<unsigned long> abortedGames = 0;
+
+    std::mutex latencyMutex;
+    std::vector<TestClient::clock::duration> operationLatencies; ///< GameOperation -> GameStatus
+
+    void addLatency(TestClient::clock::duration latency) {
+        std::lock_guard<std::mutex> guard(latencyMutex);
+        operationLatencies.push_back(latency);
+    }
+};
+
+/**
+ * Plays games with one bot pair and a number of spectators against a single server.
+ */
+class BotPair {
+    public:
+        /**
+         * @param botHost Host of the bots, differs from host if the bots connect via the unix socket
+         */
+        BotPair(unsigned int index, std::string host, std::string botHost, uint16_t port, unsigned int spectators,
+                std::chrono::seconds gameTimeout, LoadStatistics &statistics) :
+                index(index), host(std::move(host)), botHost(std::move(botHost)), port(port),
+                spectatorCount(spectators), gameTimeout(gameTimeout), statistics(statistics) {}
+
+        void play(unsigned int games) {
+            // Start of the attempts of the current game, a game rejected for longer than the timeout is aborted
+            auto firstAttempt = std::chrono::steady_clock::now();
+            for (unsigned int game = 0; game < games;) {
+                switch (playGame(game)) {
+                    case Result::finished:
+                        statistics.finishedGames++;
+                        game++;
+                        firstAttempt = std::chrono::steady_clock::now();
+                        break;
+                    case Result::rejected:
+                        if (std::chrono::steady_clock::now() - firstAttempt > gameTimeout) {
+                            spdlog::error("Pair {}: game {} rejected by the server for {} s", index, game,
+                                          gameTimeout.count());
+                            statistics.abortedGames++;
+                            game++;
+                            firstAttempt = std::chrono::steady_clock::now();
+                            break;
+                        }
+                        // previous match is still being closed by the server, try again shortly
+                        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+                        break;
+                    case Result::timeout:
+                        spdlog::error("Pair {}: game {} timed out", index, game);
+                        statistics.abortedGames++;
+                        game++;
+                        firstAttempt = std::chrono::steady_clock::now();
+                        break;
+                }
+            }
+        }
+
+    private:
+        enum class Result {
+            finished,
+            rejected,
+            timeout
+        };
+
+        unsigned int index;
+        std::string host;
+        std::string botHost;
+        uint16_t port;
+        unsigned int spectatorCount;
+        std::chrono::seconds gameTimeout;
+        LoadStatistics &statistics;
+
+        std::mutex mutex;
+        std::condition_variable gameEnd;
+        bool finished = false;
+        bool rejected = false;
+
+        void attach(TestClient &client) {
+            client.messageHook = [this, &client](const spy::network::MessageContainer &container,
+                                                 const nlohmann::json &) {
+                statistics.receivedMessages++;
+
+                switch (container.getType()) {
+                    case MessageTypeEnum::GAME_STATUS:
+                        if (client.operationSentAt.has_value()) {
+                            statistics.addLatency(TestClient::clock::now() - client.operationSentAt.value());
+                            client.operationSentAt.reset();
+                        }
+                        break;
+                    case MessageTypeEnum::STATISTICS: {
+                        std::lock_guard<std::mutex> guard(mutex);
+                        finished = true;
+                        gameEnd.notify_all();
+                        break;
+                    }
+                    case MessageTypeEnum::ERROR: {
+                        // the only error before the HelloReply is a rejected Hello
+                        if (client.id == spy::util::UUID{}) {
+                            std::lock_guard<std::mutex> guard(mutex);
+                            rejected = true;
+                            gameEnd.notify_all();
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            };
+        }
+
+        Result playGame(unsigned int game) {
+            {
+                // The message hooks run on the threads of the clients and set the flags under the same lock
+                std::lock_guard<std::mutex> guard(mutex);
+                finished = false;
+                rejected = false;
+            }
+
+            std::list<TestClient> clients;
+            auto &p1 = clients.emplace_back(fmt::format("bot-{}-{}-a", index, game),
+                                            spy::network::RoleEnum::PLAYER, botHost, port);
+            auto &p2 = clients.emplace_back(fmt::format("bot-{}-{}-b", index, game),
+                                            spy::network::RoleEnum::AI, botHost, port);
+            p1.playOperations = true;
+            p2.playOperations = true;
+            for (unsigned int i = 0; i < spectatorCount; i++) {
+                clients.emplace_back(fmt::format("spectator-{}-{}", index, i),
+                                     spy::network::RoleEnum::SPECTATOR, host, port);
+            }
+
+            for (auto &client : clients) {
+                attach(client);
+            }
+            for (auto &client : clients) {
+                client.sendHello();
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            bool done = gameEnd.wait_for(lock, gameTimeout, [this]() {
+                return finished or rejected;
+            });
+            bool wasRejected = rejected;
+            lock.unlock();
+
+            for (auto &client : clients) {
+                client.disconnect();
+                statistics.sentMessages += client.sentMessages;
+            }
+
+            if (not done) {
+                return Result::timeout;
+            }
+            return wasRejected ? Result::rejected : Result::finished;
+        }
+};
+
+static double toMilliseconds(TestClient::clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+int main(int argc, char *argv[]) {
+    CLI::App app{"Load generator for server017"};
+
+    std::string host = "localhost";
+    uint16_t basePort = 7007;
+    unsigned int pairs = 1;
+    unsigned int spectators = 0;
+    unsigned int games = 1;
+    unsigned int timeoutSeconds = 600;
+    std::string ipcSocket;
+
+    app.add_option("--host", host, "Host of the servers");
+    app.add_option("--port,-p", basePort, "Port of the first server, pair i connects to port + i");
+    app.add_option("--pairs,-n", pairs, "Number of concurrent bot pairs")->check(CLI::PositiveNumber);
+    app.add_option("--spectators,-s", spectators, "Number of spectators per bot pair");
+    app.add_option("--games,-g", games, "Number of games played by each pair")->check(CLI::PositiveNumber);
+    app.add_option("--timeout", timeoutSeconds, "Timeout for a single game in seconds");
+    app.add_option("--ipc", ipcSocket, "Unix socket path prefix of the servers, the bots of pair i connect to "
+                                       "<path><i> instead of the websocket");
+
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError &e) {
+        return app.exit(e);
+    }
+
+    spdlog::set_level(spdlog::level::level_enum::warn);
+
+    LoadStatistics statistics;
+    std::vector<std::unique_ptr<BotPair>> botPairs;
+    std::vector<std::thread> threads;
+
+    auto start = TestClient::clock::now();
+    for (unsigned int i = 0; i < pairs; i++) {
+        auto botHost = ipcSocket.empty() ? host : "unix:" + ipcSocket + std::to_string(i);
+        auto &pair = botPairs.emplace_back(std::make_unique<BotPair>(
+                i, host, botHost, static_cast<uint16_t>(basePort + i), spectators,
+                std::chrono::seconds{timeoutSeconds}, statistics));
+        threads.emplace_back([botPair = pair.get(), games]() {
+            botPair->play(games);
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    auto elapsed = std::chrono::duration<double>(TestClient::clock::now() - start).count();
+
+    auto &latencies = statistics.operationLatencies;
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        auto idx = static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1));
+        return toMilliseconds(latencies.at(idx));
+    };
+
+    std::cout << "pairs:            " << pairs << " (" << spectators << " spectators each)\n"
+              << "games finished:   " << statistics.finishedGames << "\n"
+              << "games aborted:    " << statistics.abortedGames << "\n"
+              << "elapsed:          " << elapsed << " s\n"
+              << "games/s:          " << static_cast<double>(statistics.finishedGames) / elapsed << "\n"
+              << "messages/s (rx):  " << static_cast<double>(statistics.receivedMessages) / elapsed << "\n"
+              << "messages/s (tx):  " << static_cast<double>(statistics.sentMessages) / elapsed << "\n"
+              << "operations:       " << latencies.size() << "\n"
+              << "latency p50:      " << percentile(0.5) << " ms\n"
+              << "latency p90:      " << percentile(0.9) << " ms\n"
+              << "latency p99:      " << percentile(0.99) << " ms\n"
+              << "latency max:      " << percentile(1.0) << " ms" << std::endl;
+
+    return statistics.abortedGames == 0 ? 0 : 1;
+}
@@ -0,0 +1,348 @@
+/**
+ * @file   main.cpp
+ * @brief  Replays a traffic capture (--x capture) against an in-process server and reports throughput and latency.
+ * @details The server runs on an in-memory transport. By default the capture is replayed as fast as possible on a
+ *          virtual clock that is moved to the timestamp of every record, so timeouts expire as in the original
+ *          session without waiting. With --paced the records are replayed at their original pacing on the system
+ *          clock.
+ *
+ *          The replayed server is started with the seed recorded in the capture, so it draws the same placements
+ *          and round orders. Client ids, character UUIDs and item offers differ, thus every inbound frame is
+ *          rewritten before it is replayed (see SessionMapping). The outcome of actions is still drawn at random,
+ *          the replayed game may diverge once an action has another outcome than in the captured game. The error
+ *          messages the server sends are counted to show how much of the capture was rejected.
+ */
+
+#include <CLI/CLI.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <variant>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <Server.hpp>
+#include <network/MessageContainer.hpp>
+#include <network/messages/HelloReply.hpp>
+#include <network/messages/ItemChoice.hpp>
+#include <network/messages/RequestItemChoice.hpp>
+#include <network/TrafficCapture.hpp>
+#include <network/transport/InMemoryTransport.hpp>
+#include <util/Clock.hpp>
+
+/**
+ * Maps the ids of the captured session to the ones of the replayed session.
+ *  - A client id is mapped to the id the replayed server sent in the HelloReply on the same connection, when the
+ *    captured client id is first used on that connection.
+ *  - A chosen character or gadget is mapped by its index in the offer: the captured choice is looked up in the
+ *    captured offer, the item at the same index of the offer of the replayed server is chosen instead. The
+ *    offers of both sessions have the same size, as both players make the same choices in the same order.
+ * Ids are rewritten wherever they occur in a message, i.e. in values and in keys (e.g. of the equipment choice).
+ */
+class SessionMapping {
+    public:
+        /**
+         * Handles a frame the replayed server sent on a connection.
+         */
+        void sent(std::uint32_t connection, const nlohmann::json &message) {
+            using spy::network::messages::MessageTypeEnum;
+            switch (message.get<spy::network::MessageContainer>().getType()) {
+                case MessageTypeEnum::HELLO_REPLY:
+                    replayedClients[connection] = text(message.get<spy::network::messages::HelloReply>()
+                                                              .getClientId());
+                    break;
+                case MessageTypeEnum::REQUEST_ITEM_CHOICE:
+                    replayedOffers[text(message.at("clientId"))] = offerFrom(message);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        /**
+         * Handles an item offer the captured server sent.
+         */
+        void capturedOffer(const nlohmann::json &message) {
+            capturedOffers[text(message.at("clientId"))] = offerFrom(message);
+        }
+
+        /**
+         * @return The frame with the ids of the replayed session
+         */
+        std::string rewrite(std::uint32_t connection, const std::string &frame) {
+            using spy::network::messages::MessageTypeEnum;
+
+            auto message = nlohmann::json::parse(frame, nullptr, false);
+            if (not message.is_object() or not message.contains("clientId") or not message.at("clientId").is_string()) {
+                return frame;
+            }
+
+            std::string client = message.at("clientId");
+            MessageTypeEnum type;
+            try {
+                type = message.get<spy::network::MessageContainer>().getType();
+            } catch (const nlohmann::json::exception &) {
+                return frame;
+            }
+
+            auto replayedClient = replayedClients.find(connection);
+            if (type != MessageTypeEnum::HELLO and replayedClient != replayedClients.end()) {
+                ids.emplace(client, replayedClient->second);
+            }
+            if (type == MessageTypeEnum::ITEM_CHOICE) {
+                mapChoice(client, message);
+            }
+
+            replaceIds(message, gadgets[client]);
+            return message.dump();
+        }
+
+    private:
+        struct Offer {
+            std::vector<std::string> characters;
+            std::vector<std::string> gadgets;
+        };
+
+        std::map<std::uint32_t, std::string> replayedClients;                  ///< Replayed client per connection
+        std::map<std::string, std::string> ids;                                ///< Captured -> replayed id
+        std::map<std::string, std::map<std::string, std::string>> gadgets;     ///< Per captured client
+        std::map<std::string, Offer> capturedOffers;                           ///< Per captured client
+        std::map<std::string, Offer> replayedOffers;                           ///< Per replayed client
+
+        template<typename T>
+        static std::string text(const T &value) {
+            return nlohmann::json(value).template get<std::string>();
+        }
+
+        static Offer offerFrom(const nlohmann::json &message) {
+            auto request = message.get<spy::network::messages::RequestItemChoice>();
+            Offer offer;
+            for (const auto &character : request.getOfferedCharacterIds()) {
+                offer.characters.push_back(text(character));
+            }
+            for (const auto &gadget : request.getOfferedGadgets()) {
+                offer.gadgets.push_back(text(gadget));
+            }
+            return offer;
+        }
+
+        /**
+         * Adds the item at the index of the captured choice in the captured offer to the mapping.
+         */
+        void mapChoice(const std::string &client, const nlohmann::json &message) {
+            auto replayedClient = ids.find(client);
+            auto capturedOffer = capturedOffers.find(client);
+            if (replayedClient == ids.end() or capturedOffer == capturedOffers.end()) {
+                return;
+            }
+            auto replayedOffer = replayedOffers.find(replayedClient->second);
+            if (replayedOffer == replayedOffers.end()) {
+                return;
+            }
+
+            auto mapItem = [](const std::vector<std::string> &captured, const std::vector<std::string> &replayed,
+                              const std::string &item, std::map<std::string, std::string> &mapping) {
+                auto index = static_cast<std::size_t>(std::distance(captured.begin(),
+                                                                    std::find(captured.begin(), captured.end(),
+                                                                              item)));
+                if (index < replayed.size()) {
+                    mapping[item] = replayed.at(index);
+                }
+            };
+
+            auto choice = message.get<spy::network::messages::ItemChoice>().getChoice();
+            if (std::holds_alternative<spy::util::UUID>(choice)) {
+                mapItem(capturedOffer->second.characters, replayedOffer->second.characters,
+                        text(std::get<spy::util::UUID>(choice)), ids);
+            } else {
+                mapItem(capturedOffer->second.gadgets, replayedOffer->second.gadgets,
+                        text(std::get<spy::gadget::GadgetEnum>(choice)), gadgets[client]);
+            }
+        }
+
+        void replaceIds(nlohmann::json &value, const std::map<std::string, std::string> &clientGadgets) const {
+            auto replacement = [this, &clientGadgets](const std::string &original) {
+                auto id = ids.find(original);
+                if (id != ids.end()) {
+                    return id->second;
+                }
+                auto gadget = clientGadgets.find(original);
+                return gadget != clientGadgets.end() ? gadget->second : original;
+            };
+
+            if (value.is_string()) {
+                value = replacement(value.get<std::string>());
+            } else if (value.is_array()) {
+                for (auto &element : value) {
+                    replaceIds(element, clientGadgets);
+                }
+            } else if (value.is_object()) {
+                auto object = nlohmann::json::object();
+                for (auto &[key, element] : value.items()) {
+                    replaceIds(element, clientGadgets);
+                    object[replacement(key)] = std::move(element);
+                }
+                value = std::move(object);
+            }
+        }
+};
+
+using benchClock = std::chrono::steady_clock;
+
+static double toMicroseconds(benchClock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+int main(int argc, char *argv[]) {
+    CLI::App app{"Replays captured traffic against an in-process server017"};
+
+    std::string capturePath;
+    std::string characterPath = std::string{SERVER017_CONFIG_DIR} + "/characters.json";
+    std::string matchPath = std::string{SERVER017_CONFIG_DIR} + "/matchconfig.match";
+    std::string scenarioPath = std::string{SERVER017_CONFIG_DIR} + "/scenario.scenario";
+    bool paced = false;
+    unsigned int verbosity = 1;
+
+    app.add_option("capture", capturePath, "Capture file written with --x capture")->required()
+            ->check(CLI::ExistingFile);
+    app.add_option("--config-charset,-c", characterPath, "Character configuration the capture was recorded with");
+    app.add_option("--config-match,-m", matchPath, "Match configuration the capture was recorded with");
+    app.add_option("--config-scenario,-s", scenarioPath, "Scenario configuration the capture was recorded with");
+    app.add_flag("--paced", paced, "Replay at the original pacing instead of as fast as possible");
+    app.add_option("--verbosity,-v", verbosity, "Logging verbosity of the server");
+
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError &e) {
+        return app.exit(e);
+    }
+
+    std::vector<TrafficCapture::Record> records;
+    try {
+        records = TrafficCapture::read(capturePath);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    // Captures without seed record were written by an older server, the replay then draws its own numbers
+    std::map<std::string, std::string> options{{"logFile", "none"}};
+    auto seedRecord = std::find_if(records.begin(), records.end(), [](const TrafficCapture::Record &record) {
+        return record.kind == TrafficCapture::Kind::seed;
+    });
+    if (seedRecord != records.end()) {
+        options["seed"] = seedRecord->payload;
+    }
+
+    auto transport = std::make_shared<transport::InMemoryTransport>();
+    auto virtualClock = std::make_shared<VirtualClock>();
+    std::shared_ptr<Clock> serverClock = paced ? std::shared_ptr<Clock>{std::make_shared<SystemClock>()}
+                                               : std::shared_ptr<Clock>{virtualClock};
+    afsm::state_machine<Server> server{transport, verbosity, characterPath, matchPath, scenarioPath,
+                                       options, serverClock};
+
+    std::map<std::uint32_t, std::shared_ptr<transport::InMemoryConnection>> connections;
+    std::vector<benchClock::duration> latencies;
+    latencies.reserve(records.size());
+    unsigned long sentFrames = 0;
+    unsigned long sentBytes = 0;
+    unsigned long skippedRecords = 0;
+    unsigned long sentErrors = 0;
+    SessionMapping mapping;
+
+    auto drain = [&connections, &sentFrames, &sentBytes, &sentErrors, &mapping]() {
+        for (auto &[id, connection] : connections) {
+            for (const auto &frame : connection->takeSent()) {
+                sentFrames++;
+                sentBytes += frame.size();
+                auto message = nlohmann::json::parse(frame);
+                if (message.value("type", "") == "ERROR") {
+                    sentErrors++;
+                }
+                mapping.sent(id, message);
+            }
+        }
+    };
+
+    const auto start = benchClock::now();
+    for (const auto &record : records) {
+        if (paced) {
+            std::this_thread::sleep_until(start + record.time);
+        } else {
+            virtualClock->advance(std::chrono::duration_cast<Clock::duration>(record.time) -
+                                  (virtualClock->now() - Clock::time_point{}));
+        }
+
+        switch (record.kind) {
+            case TrafficCapture::Kind::connect:
+                connections[record.connection] = transport->connect();
+                break;
+
+            case TrafficCapture::Kind::message: {
+                auto connection = connections.find(record.connection);
+                if (connection == connections.end()) {
+                    skippedRecords++;
+                    break;
+                }
+                auto frame = mapping.rewrite(record.connection, record.payload);
+                // The server handles the frame synchronously, so this is the processing time of the message
+                auto before = benchClock::now();
+                connection->second->receive(frame);
+                latencies.push_back(benchClock::now() - before);
+                break;
+            }
+
+            case TrafficCapture::Kind::close: {
+                auto connection = connections.find(record.connection);
+                if (connection == connections.end()) {
+                    skippedRecords++;
+                    break;
+                }
+                transport->close(connection->second);
+                drain();
+                connections.erase(connection);
+                break;
+            }
+
+            case TrafficCapture::Kind::sent: {
+                auto message = nlohmann::json::parse(record.payload, nullptr, false);
+                if (message.is_object()) {
+                    mapping.capturedOffer(message);
+                }
+                break;
+            }
+
+            case TrafficCapture::Kind::seed:
+                break;
+        }
+        drain();
+    }
+    auto elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        auto idx = static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1));
+        return toMicroseconds(latencies.at(idx));
+    };
+
+    std::cout << "mode:             " << (paced ? "paced" : "fast") << "\n"
+              << "seed:             " << (seedRecord != records.end() ? seedRecord->payload : "none") << "\n"
+              << "records:          " << records.size() << " (" << skippedRecords << " skipped)\n"
+              << "messages (rx):    " << latencies.size() << "\n"
+              << "frames (tx):      " << sentFrames << " (" << sentBytes << " bytes)\n"
+              << "errors (tx):      " << sentErrors << "\n"
+              << "elapsed:          " << elapsed << " s\n"
+              << "messages/s (rx):  " << static_cast<double>(latencies.size()) / elapsed << "\n"
+              << "latency p50:      " << percentile(0.5) << " us\n"
+              << "latency p90:      " << percentile(0.9) << " us\n"
+              << "latency p99:      " << percentile(0.99) << " us\n"
+              << "latency max:      " << percentile(1.0) << " us" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file   main.cpp
+ * @brief  Pause, reconnect and strike scenarios of the test client, run in-process on a virtual clock.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ServerHarness.hpp>
+
+namespace {
+    using harness::HarnessClient;
+    using harness::ServerHarness;
+    using spy::network::messages::MessageTypeEnum;
+    using std::chrono::seconds;
+
+    struct Match {
+        ServerHarness server;
+        HarnessClient &p1;
+        HarnessClient &p2;
+        spy::MatchConfig config;
+
+        /**
+         * Plays the choice and equip phase, after that the first operation request stays unanswered.
+         */
+        Match() : server{std::string{SERVER017_CONFIG_DIR} + "/characters.json",
+                         std::string{SERVER017_CONFIG_DIR} + "/matchconfig.match",
+                         std::string{SERVER017_CONFIG_DIR} + "/scenario.scenario"},
+                  p1{server.addClient("Player 1", spy::network::RoleEnum::PLAYER)},
+                  p2{server.addClient("Player 2", spy::network::RoleEnum::AI)} {
+            p1.playOperations = false;
+            p2.playOperations = false;
+            server.pump();
+            config = p1.matchConfig.value();
+        }
+
+        seconds pauseLimit() const {
+            return seconds{config.getPauseLimit().value()};
+        }
+
+        seconds reconnectLimit() const {
+            return seconds{config.getReconnectLimit().value()};
+        }
+
+        seconds turnPhaseLimit() const {
+            return seconds{config.getTurnPhaseLimit().value()};
+        }
+    };
+
+    unsigned int count(const HarnessClient &client, MessageTypeEnum type) {
+        auto it = client.receivedByType.find(type);
+        return it == client.receivedByType.end() ? 0 : it->second;
+    }
+
+    bool check(bool condition, const std::string &description) {
+        if (not condition) {
+            std::cout << "    failed: " << description << std::endl;
+        }
+        return condition;
+    }
+
+    bool pauseLimitReached() {
+        Match m;
+        m.p1.sendRequestPause(true);
+        m.server.advance(m.pauseLimit() - seconds{1});
+        bool ok = check(count(m.p2, MessageTypeEnum::GAME_PAUSE) == 1, "pause is broadcast");
+        m.server.advance(seconds{1});
+        ok &= check(count(m.p2, MessageTypeEnum::GAME_PAUSE) == 2, "server unpauses after the pause limit");
+        return ok;
+    }
+
+    bool unpauseWithinLimit() {
+        Match m;
+        m.p1.sendRequestPause(true);
+        m.server.advance(seconds{3});
+        m.p1.sendRequestPause(false);
+        m.server.advance(m.pauseLimit());
+        return check(count(m.p2, MessageTypeEnum::GAME_PAUSE) == 2, "no forced unpause after unpausing");
+    }
+
+    bool reconnectWithinLimit() {
+        Match m;
+        m.server.disconnect(m.p1);
+        m.server.advance(m.reconnectLimit() - seconds{1});
+        bool ok = check(count(m.p2, MessageTypeEnum::GAME_PAUSE) == 1, "disconnect pauses the game");
+        m.server.reconnect(m.p1);
+        m.server.pump();
+        ok &= check(count(m.p1, MessageTypeEnum::GAME_STARTED) == 2, "GameStarted is sent after reconnect");
+        // past the expiry of the reconnect timer, but before the next turn phase timeout
+        m.server.advance(seconds{2});
+        ok &= check(not m.p2.gameOver, "reconnect timer is stopped");
+        return ok;
+    }
+
+    bool reconnectReachesOnlyReturningPlayer() {
+        Match m;
+        bool p1Requested = count(m.p1, MessageTypeEnum::REQUEST_GAME_OPERATION) > 0;
+        m.server.disconnect(m.p1);
+        m.server.advance(seconds{1});
+        auto p1Status = count(m.p1, MessageTypeEnum::GAME_STATUS);
+        auto p1Requests = count(m.p1, MessageTypeEnum::REQUEST_GAME_OPERATION);
+        auto p2Status = count(m.p2, MessageTypeEnum::GAME_STATUS);
+        auto p2Requests = count(m.p2, MessageTypeEnum::REQUEST_GAME_OPERATION);
+        m.server.reconnect(m.p1);
+        m.server.pump();
+        bool ok = check(count(m.p1, MessageTypeEnum::GAME_STATUS) == p1Status + 1, "last GameStatus is resent");
+        ok &= check(count(m.p1, MessageTypeEnum::REQUEST_GAME_OPERATION) == p1Requests + (p1Requested ? 1 : 0),
+                    "pending operation request is resent");
+        ok &= check(count(m.p2, MessageTypeEnum::GAME_STATUS) == p2Status, "no GameStatus for the other player");
+        ok &= check(count(m.p2, MessageTypeEnum::REQUEST_GAME_OPERATION) == p2Requests,
+                    "no new request for the other player");
+        return ok;
+    }
+
+    bool bothDisconnected() {
+        Match m;
+        m.server.disconnect(m.p2);
+        m.server.advance(seconds{3});
+        m.server.disconnect(m.p1);
+        m.server.advance(seconds{10});
+        m.server.reconnect(m.p1);
+        m.server.reconnect(m.p2);
+        // past the expiry of both reconnect timers (player two's at R, player one's at R + 3s, now is 13s)
+        m.server.advance(m.reconnectLimit() - seconds{9});
+        return check(not m.p1.gameOver and not m.p2.gameOver, "game continues after both reconnected");
+    }
+
+    bool wrongSessionId() {
+        Match m;
+        m.server.disconnect(m.p1);
+        m.server.advance(seconds{1});
+        m.server.reconnect(m.p1, true);
+        m.server.pump();
+        bool ok = check(count(m.p1, MessageTypeEnum::ERROR) == 1, "SESSION_DOES_NOT_EXIST error is sent");
+        m.server.reconnect(m.p1);
+        m.server.pump();
+        ok &= check(count(m.p1, MessageTypeEnum::GAME_STARTED) == 2, "reconnect with correct session works");
+        return ok;
+    }
+
+    bool reconnectLimitReached() {
+        Match m;
+        m.server.disconnect(m.p1);
+        m.server.advance(m.reconnectLimit());
+        return check(m.p2.gameOver, "game ends after the reconnect limit");
+    }
+
+    bool strikeLimitReached() {
+        Match m;
+        auto strikeMax = m.config.getStrikeMaximum();
+        // at most 2 * strikeMax - 1 timeouts until one of the players reaches the maximum
+        m.server.advance(m.turnPhaseLimit() * (2 * strikeMax - 1));
+        auto strikes = std::max(count(m.p1, MessageTypeEnum::STRIKE), count(m.p2, MessageTypeEnum::STRIKE));
+        bool ok = check(strikes == strikeMax, "a player reaches the strike maximum");
+        ok &= check(m.p1.gameOver or m.p2.gameOver, "the game ends once the strike maximum is reached");
+        return ok;
+    }
+}
+
+int main() {
+    const std::vector<std::pair<std::string, std::function<bool()>>> scenarios = {
+            {"pause limit reached",     pauseLimitReached},
+            {"unpause within limit",    unpauseWithinLimit},
+            {"reconnect within limit",  reconnectWithinLimit},
+            {"reconnect only resends",  reconnectReachesOnlyReturningPlayer},
+            {"both players disconnect", bothDisconnected},
+            {"wrong session id",        wrongSessionId},
+            {"reconnect limit reached", reconnectLimitReached},
+            {"strike limit reached",    strikeLimitReached}
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int failed = 0;
+    for (const auto &[name, scenario] : scenarios) {
+        std::cout << name << std::endl;
+        if (not scenario()) {
+            failed++;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << scenarios.size() - failed << "/" << scenarios.size() << " scenarios passed in " << elapsed.count()
+              << " ms" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,229 @@
+/**
+ * @file   main.cpp
+ * @brief  Plays many complete matches in-process to evaluate match configurations.
+ * @details Every worker thread runs its own server on an in-memory transport and a virtual clock (see
+ *          test/harness), both players choose and play like the NPCs. The servers are created on the main thread
+ *          before the workers start. The workers take the next game from a shared counter until all games are
+ *          played, so a worker that finishes early keeps taking games instead of waiting for the others. Reports
+ *          the win rate, the length of the games and the victory reasons.
+ */
+
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <ServerHarness.hpp>
+
+using spy::statistics::VictoryEnum;
+
+/**
+ * Results of the games played by one worker, merged after all workers are done.
+ */
+struct SimulationResults {
+    std::array<unsigned long, 2> wins = {0, 0};
+    std::map<VictoryEnum, unsigned long> victoryReasons;
+    std::vector<unsigned int> rounds;
+    std::vector<unsigned long> operations;
+    unsigned long failedGames = 0;
+
+    void add(const harness::MatchResult &result) {
+        wins.at(static_cast<std::size_t>(result.winner))++;
+        victoryReasons[result.reason]++;
+        rounds.push_back(result.rounds);
+        operations.push_back(result.operations);
+    }
+
+    void merge(const SimulationResults &other) {
+        for (std::size_t i = 0; i < wins.size(); i++) {
+            wins.at(i) += other.wins.at(i);
+        }
+        for (const auto &[reason, count] : other.victoryReasons) {
+            victoryReasons[reason] += count;
+        }
+        rounds.insert(rounds.end(), other.rounds.begin(), other.rounds.end());
+        operations.insert(operations.end(), other.operations.begin(), other.operations.end());
+        failedGames += other.failedGames;
+    }
+
+    [[nodiscard]] unsigned long games() const {
+        return rounds.size();
+    }
+};
+
+struct SimulationConfig {
+    std::string characterPath;
+    std::string matchPath;
+    std::string scenarioPath;
+    std::map<std::string, std::string> options;
+    unsigned int games;
+    unsigned int seed;
+};
+
+/**
+ * Creates a server on the calling thread. The server replaces the global logger on construction, which must not
+ * happen while other servers are playing, thus servers are only created while no worker is running.
+ */
+static std::unique_ptr<harness::ServerHarness> createServer(const SimulationConfig &config) {
+    return std::make_unique<harness::ServerHarness>(config.characterPath, config.matchPath, config.scenarioPath,
+                                                    config.options);
+}
+
+/**
+ * Plays games until all games are taken. After a failed game the server may still be in that game, so the worker
+ * stops and its server is replaced before the next batch of workers starts.
+ * @return False if a game failed
+ */
+static bool simulate(const SimulationConfig &config, harness::ServerHarness &server,
+                     std::atomic<unsigned int> &nextGame, SimulationResults &results) {
+    for (auto game = nextGame++; game < config.games; game = nextGame++) {
+        try {
+            results.add(server.playSeededMatch(config.seed + 2 * game));
+        } catch (const std::exception &e) {
+            std::cerr << "Game " << game << " failed: " << e.what() << std::endl;
+            results.failedGames++;
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+static T percentile(const std::vector<T> &sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted.at(static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1)));
+}
+
+template<typename T>
+static double mean(const std::vector<T> &values) {
+    if (values.empty()) {
+        return 0;
+    }
+    double sum = 0;
+    for (const auto &value : values) {
+        sum += static_cast<double>(value);
+    }
+    return sum / static_cast<double>(values.size());
+}
+
+static double share(unsigned long count, unsigned long total) {
+    return total == 0 ? 0 : 100.0 * static_cast<double>(count) / static_cast<double>(total);
+}
+
+int main(int argc, char *argv[]) {
+    CLI::App app{"Plays complete matches between NPC players in-process to evaluate match configurations"};
+
+    SimulationConfig config{std::string{SERVER017_CONFIG_DIR} + "/characters.json",
+                            std::string{SERVER017_CONFIG_DIR} + "/matchconfig.match",
+                            std::string{SERVER017_CONFIG_DIR} + "/scenario.scenario",
+                            {}, 1000, std::random_device{}()};
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> keyValueStrings;
+
+    app.add_option("--config-charset,-c", config.characterPath, "Path to the character configuration file")
+            ->check(CLI::ExistingFile);
+    app.add_option("--config-match,-m", config.matchPath, "Path to the match configuration file")
+            ->check(CLI::ExistingFile);
+    app.add_option("--config-scenario,-s", config.scenarioPath, "Path to the scenario configuration file")
+            ->check(CLI::ExistingFile);
+    app.add_option("--games,-n", config.games, "Number of games to play")->check(CLI::PositiveNumber);
+    app.add_option("--threads,-j", threads, "Number of worker threads, one per core by default")
+            ->check(CLI::PositiveNumber);
+    app.add_option("--seed", config.seed, "Seed of the choices and operations of the players, random by default");
+    app.add_option("--x", keyValueStrings, "Additional key value pairs for the server");
+
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError &e) {
+        return app.exit(e);
+    }
+
+    for (unsigned int i = 0; i + 1 < keyValueStrings.size(); i += 2) {
+        config.options[keyValueStrings.at(i)] = keyValueStrings.at(i + 1);
+    }
+
+    std::atomic<unsigned int> nextGame = 0;
+    std::vector<SimulationResults> workerResults(threads);
+    std::vector<std::unique_ptr<harness::ServerHarness>> servers(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    // Every failed game stops its worker, thus this loop ends after at most one batch per failed game
+    while (nextGame < config.games) {
+        for (auto &server : servers) {
+            if (server == nullptr) {
+                server = createServer(config);
+            }
+        }
+
+        std::vector<std::thread> workers;
+        std::vector<char> failed(threads, false);
+        for (std::size_t i = 0; i < threads; i++) {
+            workers.emplace_back([&config, &server = *servers.at(i), &nextGame, &results = workerResults.at(i),
+                                         &workerFailed = failed.at(i)]() {
+                workerFailed = not simulate(config, server, nextGame, results);
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        for (std::size_t i = 0; i < threads; i++) {
+            if (failed.at(i)) {
+                servers.at(i).reset();
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    SimulationResults results;
+    for (const auto &worker : workerResults) {
+        results.merge(worker);
+    }
+    std::sort(results.rounds.begin(), results.rounds.end());
+    std::sort(results.operations.begin(), results.operations.end());
+    auto games = results.games();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "match config:     " << config.matchPath << "\n"
+              << "seed:             " << config.seed << "\n"
+              << "threads:          " << threads << "\n"
+              << "games finished:   " << games << "\n"
+              << "games failed:     " << results.failedGames << "\n"
+              << "elapsed:          " << elapsed << " s\n"
+              << "games/min:        " << static_cast<double>(games) * 60 / elapsed << "\n"
+              << "wins player one:  " << results.wins.at(0) << " (" << share(results.wins.at(0), games) << " %)\n"
+              << "wins player two:  " << results.wins.at(1) << " (" << share(results.wins.at(1), games) << " %)\n"
+              << "rounds mean:      " << mean(results.rounds) << "\n"
+              << "rounds p10/50/90: " << percentile(results.rounds, 0.1) << " / "
+              << percentile(results.rounds, 0.5) << " / " << percentile(results.rounds, 0.9) << "\n"
+              << "rounds min/max:   " << percentile(results.rounds, 0.0) << " / "
+              << percentile(results.rounds, 1.0) << "\n"
+              << "operations mean:  " << mean(results.operations) << "\n"
+              << "operations p50:   " << percentile(results.operations, 0.5) << "\n";
+
+    std::cout << "victory reasons:\n";
+    for (const auto &[reason, count] : results.victoryReasons) {
+        std::cout << "  " << std::left << std::setw(24) << nlohmann::json(reason).get<std::string>() << std::right
+                  << count << " (" << share(count, games) << " %)\n";
+    }
+
+    std::cout << "rounds:\n";
+    for (auto round = results.rounds.begin(); round != results.rounds.end();) {
+        auto next = std::upper_bound(round, results.rounds.end(), *round);
+        auto count = static_cast<unsigned long>(std::distance(round, next));
+        std::cout << "  " << std::setw(4) << *round << "  " << count << " (" << share(count, games) << " %)\n";
+        round = next;
+    }
+    std::cout << std::flush;
+
+    return results.failedGames == 0 ? 0 : 1;
+}